@@ -120,6 +120,10 @@ extern volatile BOOT_STATUS BootStatus;
 // Defines the size of the buffer used to read the boot image file.
 #define BL_READ_BUFFER_SIZE     512
 
+// Number of contiguous pieces of the image file that are mapped when it is
+// opened.  The FAT of a more fragmented file is read as it is streamed.
+#define BL_SD_MAX_EXTENTS       8
+
 
 /* Boot Loader Media Interface Call Outs
 *******************************************************************************
@@ -128,7 +132,7 @@ application image file and program it to Flash.
 *******************************************************************************
 */
 
-#define BLMedia_InitializeTransport()	FSInit()     
+#define BLMedia_InitializeTransport()	(FSInit() && BLSd_TuneClock())
 	
 #define BLMedia_DeinitializeTransport()	TRUE  
 
@@ -148,6 +152,18 @@ image file to memory.
 #define PROGRAM_FLASH_END           0x0000FC00          // End of flash
 
 #define FLASH_BLOCK_SIZE            (0x400)          // Size in bytes
+#define FLASH_WRITE_BLOCK_SIZE      (64)             // Size in bytes
+
+// Program Flash where the application keeps its own data (the Lab1 settings
+// store, NV_PAGE_A and NV_PAGE_B in nvstore.h).  It is erased after every
+// successful load, so a new image never starts from the old one's data.
+// Remove these to keep the data across loads.
+#define LOADER_CLEAR_BASE           0x0000F400
+#define LOADER_CLEAR_END            0x0000FC00
+
+// Compare the image with Flash first and only erase and program the blocks
+// that differ.  Costs a second pass over the image file.
+#define LOADER_SKIP_UNCHANGED
 
 // Optional Record Type Support (Necessary if EXTENDED_HEXFILE_SUPPORT is defined)
 #define Loader_ValidateSerialNumber(d,l)    RECORD_NON_DATA
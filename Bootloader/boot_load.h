@@ -52,6 +52,19 @@ image file to memory.
     #error "FLASH_BLOCK_SIZE must be defined in boot_config.h"
 #endif
 
+#ifndef FLASH_WRITE_BLOCK_SIZE
+    #error "FLASH_WRITE_BLOCK_SIZE must be defined in boot_config.h"
+#endif
+
+// The row writer clips at row granularity
+#if (PROGRAM_FLASH_BASE % FLASH_WRITE_BLOCK_SIZE) || (PROGRAM_FLASH_END % FLASH_WRITE_BLOCK_SIZE)
+    #error "PROGRAM_FLASH_BASE and PROGRAM_FLASH_END must be aligned to FLASH_WRITE_BLOCK_SIZE"
+#endif
+
+#ifndef PROGRAM_FLASH_LENGTH
+    #define PROGRAM_FLASH_LENGTH        (PROGRAM_FLASH_END - PROGRAM_FLASH_BASE)
+#endif
+
 #ifndef BLOCK_FILL_DEFAULT
     #define BLOCK_FILL_DEFAULT          0xFF // default value of program memory
 #endif
@@ -75,6 +88,10 @@ image file to memory.
 #define LOADER_DECODE_ERROR     4   // Error decoding raw data
 #define LOADER_ADDRESS_ERROR    5   // Block address error
 
+// Receives decoded image data: program memory address, data and length.
+// Loader_RowWrite and Loader_RowCompare are sinks.
+typedef void (*LOADER_SINK)( DWORD address, BYTE *pData, BYTE length );
+
 // Optional Record Type Support (Necessary if EXTENDED_HEXFILE_SUPPORT is defined)
 #ifndef Loader_ValidateSerialNumber
     #define Loader_ValidateSerialNumber(d,l)    RECORD_NON_DATA
@@ -88,6 +105,305 @@ image file to memory.
     #define Loader_CheckErrorDetection(d,l)     RECORD_NON_DATA
 #endif
 
+
+/* Loader Flash Programming Interface
+*******************************************************************************
+Decoded image data is collected into a row buffer one write block 
+(FLASH_WRITE_BLOCK_SIZE bytes) at a time and each row is programmed with a 
+single block write.  An erase block (FLASH_BLOCK_SIZE bytes) is erased the 
+first time a row in it is opened.  Implemented in boot_load_flash.c.
+*******************************************************************************
+*/
+
+/****************************************************************************
+  Function:
+    void Loader_RowInit ( void )
+
+  Description:
+    Empties the row buffer and marks all erase blocks as not erased before
+    an image is loaded.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    None
+***************************************************************************/
+
+void Loader_RowInit ( void );
+
+
+/****************************************************************************
+  Function:
+    void Loader_RowWrite ( DWORD address, BYTE *pData, BYTE length )
+
+  Description:
+    Copies decoded image data into the row buffer.  When the data moves on
+    to another row, the buffered row is programmed to Flash first.
+
+  Precondition:
+    Loader_RowInit must have been called.
+
+  Parameters:
+    address     - Program memory address of the first byte
+    pData       - Pointer to the data
+    length      - Number of bytes
+
+  Returns:
+    None
+
+  Remarks:
+    A row is filled from the current Flash contents when it is opened, so
+    bytes the image does not give keep their value.  Data outside of 
+    PROGRAM_FLASH_BASE to PROGRAM_FLASH_END is ignored.
+***************************************************************************/
+
+void Loader_RowWrite ( DWORD address, BYTE *pData, BYTE length );
+
+
+/****************************************************************************
+  Function:
+    void Loader_RowFlush ( void )
+
+  Description:
+    Programs the buffered row, if any, to Flash.
+
+  Precondition:
+    Loader_RowInit must have been called.
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    Must be called at the end of the image.
+***************************************************************************/
+
+void Loader_RowFlush ( void );
+
+
+/****************************************************************************
+  Function:
+    void Loader_RowCompare ( DWORD address, BYTE *pData, BYTE length )
+
+  Description:
+    Compares decoded image data with the current Flash contents and marks
+    the erase blocks that differ, so that Loader_RowWrite only programs 
+    those blocks.
+
+  Precondition:
+    Loader_RowInit must have been called.  The whole image must be compared
+    before any of it is written.
+
+  Parameters:
+    address     - Program memory address of the first byte
+    pData       - Pointer to the data
+    length      - Number of bytes
+
+  Returns:
+    None
+
+  Remarks:
+    Only used if LOADER_SKIP_UNCHANGED is defined.  Bytes of a block that 
+    the image does not give are not compared.
+***************************************************************************/
+
+#ifdef LOADER_SKIP_UNCHANGED
+void Loader_RowCompare ( DWORD address, BYTE *pData, BYTE length );
+#endif
+
+
+/****************************************************************************
+  Function:
+    BYTE Loader_BlocksProgrammed ( void )
+    BYTE Loader_BlocksSkipped ( void )
+
+  Description:
+    Give the number of erase blocks that were erased and programmed, and 
+    the number of blocks the image writes to that already held the image 
+    data and were left alone.
+
+  Precondition:
+    The image has been loaded.
+
+  Parameters:
+    None
+
+  Returns:
+    Number of erase blocks
+
+  Remarks:
+    Loader_BlocksSkipped is always 0 if LOADER_SKIP_UNCHANGED is not 
+    defined.
+***************************************************************************/
+
+BYTE Loader_BlocksProgrammed ( void );
+BYTE Loader_BlocksSkipped ( void );
+
+
+/****************************************************************************
+  Function:
+    void Loader_ClearData ( void )
+
+  Description:
+    Erases the application data blocks (LOADER_CLEAR_BASE to 
+    LOADER_CLEAR_END) that the image did not write to.
+
+  Precondition:
+    The whole image has been programmed and Loader_RowFlush called.
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    Does nothing if LOADER_CLEAR_BASE is not defined.
+***************************************************************************/
+
+void Loader_ClearData ( void );
+
+
+/* Hex Loader Interface
+*******************************************************************************
+Parses Intel HEX files as they are read, checks each record and passes the 
+data records to a sink.  Implemented in boot_load_hex.c.
+*******************************************************************************
+*/
+
+/****************************************************************************
+  Function:
+    void Loader_HexInit ( LOADER_SINK sink )
+
+  Description:
+    Prepares to parse a hex file from its first character.
+
+  Precondition:
+    None
+
+  Parameters:
+    sink        - Routine that receives the data of each data record
+
+  Returns:
+    None
+
+  Remarks:
+    None
+***************************************************************************/
+
+void Loader_HexInit ( LOADER_SINK sink );
+
+
+/****************************************************************************
+  Function:
+    BYTE Loader_HexDecode ( BYTE *pData, WORD length )
+
+  Description:
+    Parses the next piece of a hex file.  Records may be split between 
+    pieces anywhere.  Each record is checked before it is used, and the 
+    data of each data record goes to the sink.
+
+  Precondition:
+    Loader_HexInit must have been called.
+
+  Parameters:
+    pData       - Pointer to the data read from the hex file
+    length      - Number of bytes
+
+  Returns:
+    LOADER_NEED_DATA        - The file continues in the next piece
+    LOADER_EOF              - End of file record reached
+    LOADER_DECODE_ERROR     - The file is not a valid hex file
+
+  Remarks:
+    None
+***************************************************************************/
+
+BYTE Loader_HexDecode ( BYTE *pData, WORD length );
+
+
+/* Binary Image Loader Interface
+*******************************************************************************
+Decodes images in the BLF format (see boot_load_blf.h) as they are read and
+passes the payload to a sink.  Implemented in boot_load_blf.c.
+*******************************************************************************
+*/
+
+/****************************************************************************
+  Function:
+    void Loader_BlfInit ( LOADER_SINK sink )
+
+  Description:
+    Prepares to decode a BLF image from its first byte.
+
+  Precondition:
+    None
+
+  Parameters:
+    sink        - Routine that receives the payload
+
+  Returns:
+    None
+
+  Remarks:
+    None
+***************************************************************************/
+
+void Loader_BlfInit ( LOADER_SINK sink );
+
+
+/****************************************************************************
+  Function:
+    BYTE Loader_BlfDecode ( BYTE *pData, WORD length )
+
+  Description:
+    Decodes the next piece of a BLF image.
+
+  Precondition:
+    Loader_BlfInit must have been called.
+
+  Parameters:
+    pData       - Pointer to the data read from the image file
+    length      - Number of bytes
+
+  Returns:
+    LOADER_NEED_DATA        - The image continues in the next piece
+    LOADER_EOF              - The whole payload was decoded and its CRC is
+                              correct
+    LOADER_DECODE_ERROR     - Bad header, or the payload CRC is wrong
+    LOADER_ADDRESS_ERROR    - Payload does not fit in program Flash
+
+  Remarks:
+    None
+***************************************************************************/
+
+BYTE Loader_BlfDecode ( BYTE *pData, WORD length );
+
+
+/* Flash Erase Tracking
+*******************************************************************************
+One bit per erase block records if the block has been erased for the image
+being loaded.  Implemented in boot_load_hex.c.
+*******************************************************************************
+*/
+
+// Parameter flags definitions
+#define PAGE_ERASED         TRUE
+#define PAGE_NOT_ERASED     FALSE
+
+void TrackPageEraseInit(void);
+BOOL TrackPageEraseTest(unsigned long int PageAddress);
+void TrackPageErase(unsigned long int PageAddress, BOOL PageErased);
+
 /*
 *******************************************************************************
 EOF
@@ -0,0 +1,372 @@
+/*
+*******************************************************************************
+Loader for Binary Images (BLF)
+
+Decodes a BLF image (see boot_load_blf.h) as it is read from the medium, in
+pieces of any size, and passes the payload to a sink, normally the row
+writer.  The payload is already in program memory order, so decoding is
+only the header check and the CRC-32, which is done with a 16 entry table
+(two lookups a byte) to keep the table small.
+*******************************************************************************
+*/
+
+#include "GenericTypedefs.h"
+#include "HardwareProfile.h"
+#include "boot.h"
+#include "boot_load_blf.h"
+#include "Compiler.h"
+
+
+//******************************************************************************
+//******************************************************************************
+// Global Data
+//******************************************************************************
+//******************************************************************************
+
+// CRC-32 of each nibble value
+rom DWORD blfCrcTable[16] =
+{
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+// Header fields, collected from the start of the file
+BYTE            blfHeader[BLF_HEADER_USED];
+
+// Number of header bytes read, and the length of the header
+WORD            blfHeaderIndex;
+WORD            blfHeaderLength;
+
+// Program memory address of the next payload byte
+DWORD_VAL       blfAddress;
+
+// Number of payload bytes still to come
+DWORD           blfRemaining;
+
+// CRC-32 of the payload so far
+DWORD           blfCrc;
+
+// Receives the payload
+LOADER_SINK     blfSink;
+
+
+//******************************************************************************
+//******************************************************************************
+// Local Routines
+//******************************************************************************
+//******************************************************************************
+
+/****************************************************************************
+  Function:
+    DWORD HeaderField ( BYTE offset, BYTE size )
+
+  Description:
+    Reads a little endian header field.
+
+  Precondition:
+    The header fields have been read.
+
+  Parameters:
+    offset      - Offset of the field in the header
+    size        - Size of the field in bytes, 2 or 4
+
+  Returns:
+    Value of the field
+
+  Remarks:
+    None
+***************************************************************************/
+
+static DWORD HeaderField ( BYTE offset, BYTE size )
+{
+    DWORD_VAL   field;
+
+    field.Val  = 0;
+    field.v[0] = blfHeader[offset];
+    field.v[1] = blfHeader[offset + 1];
+    if (size == 4)
+    {
+        field.v[2] = blfHeader[offset + 2];
+        field.v[3] = blfHeader[offset + 3];
+    }
+    return field.Val;
+
+} // HeaderField
+
+
+/****************************************************************************
+  Function:
+    BYTE HeaderCheck ( void )
+
+  Description:
+    Checks the header fields and sets up decoding of the payload.
+
+  Precondition:
+    The header fields have been read.
+
+  Parameters:
+    None
+
+  Returns:
+    LOADER_NEED_DATA        - Header is valid
+    LOADER_DECODE_ERROR     - Not a BLF file of a supported format
+    LOADER_ADDRESS_ERROR    - Payload does not fit in program Flash
+
+  Remarks:
+    None
+***************************************************************************/
+
+static BYTE HeaderCheck ( void )
+{
+    DWORD   length;
+
+    if (blfHeader[BLF_OFFSET_MAGIC + 0] != BLF_MAGIC_0 ||
+        blfHeader[BLF_OFFSET_MAGIC + 1] != BLF_MAGIC_1 ||
+        blfHeader[BLF_OFFSET_MAGIC + 2] != BLF_MAGIC_2 ||
+        blfHeader[BLF_OFFSET_MAGIC + 3] != BLF_MAGIC_3 ||
+        HeaderField(BLF_OFFSET_FORMAT, 2) != BLF_FORMAT_VERSION)
+    {
+        return LOADER_DECODE_ERROR;
+    }
+
+    blfHeaderLength = (WORD)HeaderField(BLF_OFFSET_HEADER_LEN, 2);
+    blfAddress.Val  = HeaderField(BLF_OFFSET_ADDRESS, 4);
+    length          = HeaderField(BLF_OFFSET_LENGTH, 4);
+
+    if (blfHeaderLength < BLF_HEADER_USED || (blfHeaderLength % BLF_ROW_SIZE) ||
+        (blfAddress.Val % BLF_ROW_SIZE) || (length % BLF_ROW_SIZE))
+    {
+        return LOADER_DECODE_ERROR;
+    }
+
+    if (blfAddress.Val < PROGRAM_FLASH_BASE)
+    {
+        BLIO_ReportBootStatus(LOADER_ADDRESS_LOW, "BL Loader: Error - Image below program Flash\r\n");
+        return LOADER_ADDRESS_ERROR;
+    }
+
+    if (blfAddress.Val > PROGRAM_FLASH_END || length > PROGRAM_FLASH_END - blfAddress.Val)
+    {
+        BLIO_ReportBootStatus(LOADER_ADDRESS_HIGH, "BL Loader: Error - Image above program Flash\r\n");
+        return LOADER_ADDRESS_ERROR;
+    }
+
+    blfRemaining = length;
+    return LOADER_NEED_DATA;
+
+} // HeaderCheck
+
+
+/****************************************************************************
+  Function:
+    void CrcUpdate ( BYTE *pData, BYTE length )
+
+  Description:
+    Adds data to the CRC-32 of the payload.
+
+  Precondition:
+    None
+
+  Parameters:
+    pData       - Pointer to the data
+    length      - Number of bytes
+
+  Returns:
+    None
+
+  Remarks:
+    None
+***************************************************************************/
+
+static void CrcUpdate ( BYTE *pData, BYTE length )
+{
+    DWORD   crc;
+
+    crc = blfCrc;
+    while (length-- > 0)
+    {
+        crc ^= *pData++;
+        crc  = (crc >> 4) ^ blfCrcTable[(BYTE)crc & 0x0F];
+        crc  = (crc >> 4) ^ blfCrcTable[(BYTE)crc & 0x0F];
+    }
+    blfCrc = crc;
+
+} // CrcUpdate
+
+
+/****************************************************************************
+  Function:
+    BOOL IsGap ( BYTE *pData, BYTE length )
+
+  Description:
+    Checks if payload data is all unprogrammed (0xFF) bytes.
+
+  Precondition:
+    None
+
+  Parameters:
+    pData       - Pointer to the data
+    length      - Number of bytes
+
+  Returns:
+    TRUE        - All bytes are BLOCK_FILL_DEFAULT
+    FALSE       - The data holds image bytes
+
+  Remarks:
+    None
+***************************************************************************/
+
+static BOOL IsGap ( BYTE *pData, BYTE length )
+{
+    while (length-- > 0)
+    {
+        if (*pData++ != BLOCK_FILL_DEFAULT)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+
+} // IsGap
+
+
+//******************************************************************************
+//******************************************************************************
+// BLF Loader Interface
+//******************************************************************************
+//******************************************************************************
+
+/****************************************************************************
+  Function:
+    void Loader_BlfInit ( LOADER_SINK sink )
+
+  Description:
+    Prepares to decode a BLF image from its first byte.
+
+  Precondition:
+    None
+
+  Parameters:
+    sink        - Routine that receives the payload
+
+  Returns:
+    None
+
+  Remarks:
+    The row writer is not initialized here, so the image can be decoded
+    once to compare it and once more to program it.
+***************************************************************************/
+
+void Loader_BlfInit ( LOADER_SINK sink )
+{
+    blfHeaderIndex  = 0;
+    blfHeaderLength = BLF_HEADER_USED;
+    blfRemaining    = 0;
+    blfCrc          = BLF_CRC_INITIAL;
+    blfSink         = sink;
+
+} // Loader_BlfInit
+
+
+/****************************************************************************
+  Function:
+    BYTE Loader_BlfDecode ( BYTE *pData, WORD length )
+
+  Description:
+    Decodes the next piece of a BLF image.
+
+  Precondition:
+    Loader_BlfInit must have been called.
+
+  Parameters:
+    pData       - Pointer to the data read from the image file
+    length      - Number of bytes
+
+  Returns:
+    LOADER_NEED_DATA        - The image continues in the next piece
+    LOADER_EOF              - The whole payload was decoded and its CRC is
+                              correct
+    LOADER_DECODE_ERROR     - Bad header, or the payload CRC is wrong
+    LOADER_ADDRESS_ERROR    - Payload does not fit in program Flash
+
+  Remarks:
+    Data after the end of the payload is ignored.
+***************************************************************************/
+
+BYTE Loader_BlfDecode ( BYTE *pData, WORD length )
+{
+    BYTE    result;
+    BYTE    count;      // Number of bytes up to the end of the row
+
+    while (blfHeaderIndex < blfHeaderLength)
+    {
+        if (length == 0)
+        {
+            return LOADER_NEED_DATA;
+        }
+
+        if (blfHeaderIndex < BLF_HEADER_USED)
+        {
+            blfHeader[blfHeaderIndex] = *pData;
+        }
+        blfHeaderIndex++;
+        pData++;
+        length--;
+
+        if (blfHeaderIndex == BLF_HEADER_USED)
+        {
+            result = HeaderCheck();
+            if (result != LOADER_NEED_DATA)
+            {
+                return result;
+            }
+        }
+    }
+
+    while (blfRemaining > 0 && length > 0)
+    {
+        count = BLF_ROW_SIZE - (blfAddress.byte.LB & (BLF_ROW_SIZE - 1));
+        if (count > length)
+        {
+            count = (BYTE)length;
+        }
+        if (count > blfRemaining)
+        {
+            count = (BYTE)blfRemaining;
+        }
+
+        CrcUpdate(pData, count);
+
+        if (!IsGap(pData, count))
+        {
+            blfSink(blfAddress.Val, pData, count);
+        }
+
+        blfAddress.Val += count;
+        blfRemaining   -= count;
+        pData          += count;
+        length         -= count;
+    }
+
+    if (blfRemaining > 0)
+    {
+        return LOADER_NEED_DATA;
+    }
+
+    if ((blfCrc ^ BLF_CRC_INITIAL) != HeaderField(BLF_OFFSET_CRC, 4))
+    {
+        BLIO_ReportBootStatus(LOADER_CHECKSUM_ERR, "BL Loader: Error - Image CRC mismatch\r\n");
+        return LOADER_DECODE_ERROR;
+    }
+    return LOADER_EOF;
+
+} // Loader_BlfDecode
+
+
+/*
+*******************************************************************************
+EOF
+*******************************************************************************
+*/
@@ -0,0 +1,66 @@
+/*
+*******************************************************************************
+Boot Loader Binary Image Format (BLF)
+
+A BLF file holds one contiguous piece of program memory as raw bytes, so the
+loader does not need to translate anything and the file is less than half
+the size of the same image in Intel HEX.  tools/hex2blf converts a .hex file.
+
+    +-------------------------+  offset 0
+    | Header                  |  BLF_HEADER_SIZE bytes, see below
+    +-------------------------+  offset header length
+    | Payload                 |  length bytes, programmed from load address
+    +-------------------------+
+
+All multi-byte header fields are little endian.  The load address, the
+payload length and the header length are multiples of BLF_ROW_SIZE, so
+each Flash row of the payload is one aligned piece of the file.  Rows that
+are all 0xFF are gaps in the image: they are not programmed, and erase
+blocks that only hold gaps keep their contents.
+
+This file only holds definitions, so that host tools can include it.
+*******************************************************************************
+*/
+
+#ifndef BOOT_LOAD_BLF_H
+#define BOOT_LOAD_BLF_H
+
+// File identification, the first four bytes of the file
+#define BLF_MAGIC_0             'B'
+#define BLF_MAGIC_1             'L'
+#define BLF_MAGIC_2             'F'
+#define BLF_MAGIC_3             0x1A    // Stops "type" on a DOS console
+
+// Version of this format
+#define BLF_FORMAT_VERSION      1
+
+// Flash row size the payload is aligned to
+#define BLF_ROW_SIZE            64
+
+// Header size written by hex2blf.  Unused header bytes are 0xFF.
+#define BLF_HEADER_SIZE         64
+
+// Header field offsets
+#define BLF_OFFSET_MAGIC        0       // 4 bytes, BLF_MAGIC_0..3
+#define BLF_OFFSET_FORMAT       4       // WORD, BLF_FORMAT_VERSION
+#define BLF_OFFSET_HEADER_LEN   6       // WORD, offset of the payload
+#define BLF_OFFSET_ADDRESS      8       // DWORD, load address of the payload
+#define BLF_OFFSET_LENGTH       12      // DWORD, payload length in bytes
+#define BLF_OFFSET_VERSION      16      // DWORD, application version
+#define BLF_OFFSET_CRC          20      // DWORD, CRC-32 of the payload
+
+// Number of header bytes that hold fields
+#define BLF_HEADER_USED         24
+
+// CRC-32 as used by zip and Ethernet (reflected, polynomial 0x04C11DB7),
+// initial value and final XOR both 0xFFFFFFFF
+#define BLF_CRC_POLYNOMIAL      0xEDB88320UL
+#define BLF_CRC_INITIAL         0xFFFFFFFFUL
+
+#endif
+
+/*
+*******************************************************************************
+EOF
+*******************************************************************************
+*/
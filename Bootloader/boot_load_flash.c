@@ -0,0 +1,563 @@
+/*
+*******************************************************************************
+Loader Flash Programming
+
+The PIC18F46J50 programs Flash one write block (64 bytes, a "row") at a
+time through the table write holding registers.  Each block write takes the
+same time (TIW, about 2.8ms) as a single word write, so the loader collects
+decoded image data into a row buffer and programs whole rows.
+
+Erasing works on 1 KB blocks.  A block is erased the first time the image
+writes to it, so blocks the image does not use are left alone.  A row is
+read back from Flash when it is opened (after any erase), so bytes of the
+row that the image does not give are written with the value they already
+hold.
+
+With LOADER_SKIP_UNCHANGED the media layer first passes the whole image to
+Loader_RowCompare, which marks the blocks whose Flash contents differ from
+the image.  Loader_RowWrite then only erases and programs those blocks, so
+reloading the same or a slightly changed image only rewrites what changed.
+
+After a successful load Loader_ClearData erases the application's data
+blocks (LOADER_CLEAR_BASE to LOADER_CLEAR_END) that the image did not write.
+*******************************************************************************
+*/
+
+#include "GenericTypedefs.h"
+#include "HardwareProfile.h"
+#include "boot.h"
+#include "Compiler.h"
+#include <string.h>
+
+
+//******************************************************************************
+//******************************************************************************
+// Global Data
+//******************************************************************************
+//******************************************************************************
+
+// Row assembly buffer
+BYTE            rowBuffer[FLASH_WRITE_BLOCK_SIZE];
+
+// Program memory address of the row in rowBuffer
+DWORD_VAL       rowAddress;
+
+// TRUE while rowBuffer holds a row that has not been programmed yet
+BOOL            rowPending = FALSE;
+
+#ifdef LOADER_SKIP_UNCHANGED
+
+// Erase blocks the image writes to, and those of them that differ from the
+// image.  One bit per block, as in flashPageStatus.
+unsigned long int flashBlockUsed[(NUMBER_OF_FLASH_BLOCKS + 31) / 32];
+unsigned long int flashBlockChanged[(NUMBER_OF_FLASH_BLOCKS + 31) / 32];
+
+#define BlockNumber(a)      (((a) - PROGRAM_FLASH_BASE) / FLASH_BLOCK_SIZE)
+#define BlockTest(m,a)      ((m)[BlockNumber(a)/32] &  (1UL << (BlockNumber(a)%32)))
+#define BlockSet(m,a)       ((m)[BlockNumber(a)/32] |= (1UL << (BlockNumber(a)%32)))
+
+#endif
+
+
+//******************************************************************************
+//******************************************************************************
+// Local Routines
+//******************************************************************************
+//******************************************************************************
+
+/****************************************************************************
+  Function:
+    void BlockErase ( DWORD address )
+
+  Description:
+    Erases the Flash erase block that holds the given address.
+
+  Precondition:
+    None
+
+  Parameters:
+    address     - Program memory address in the block to erase
+
+  Returns:
+    None
+
+  Remarks:
+    Execution halts for the duration of the erase.
+***************************************************************************/
+
+static void BlockErase ( DWORD address )
+{
+    DWORD_VAL   block;
+
+    block.Val = address & BLOCK_ALIGNMENT_MASK;
+    TBLPTRU = block.byte.UB;
+    TBLPTRH = block.byte.HB;
+    TBLPTRL = block.byte.LB;
+
+    EECON1 = 0b00010100;        //Block erase mode
+    INTCONbits.GIE = 0;         //Make certain interrupts disabled for unlock process.
+    _asm
+    MOVLW 0x55
+    MOVWF EECON2, 0
+    MOVLW 0xAA
+    MOVWF EECON2, 0
+    BSF EECON1, 1, 0            //Initiates erase operation (halts CPU execution until complete)
+    _endasm
+
+    //Good practice now to clear the WREN bit, as further protection against any
+    //   future accidental activation of self write/erase operations.
+    EECON1bits.WREN = 0;
+
+} // BlockErase
+
+
+/****************************************************************************
+  Function:
+    void RowRead ( void )
+
+  Description:
+    Reads the row at rowAddress from Flash into the row buffer.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    None
+***************************************************************************/
+
+static void RowRead ( void )
+{
+    BYTE    i;
+
+    TBLPTRU = rowAddress.byte.UB;
+    TBLPTRH = rowAddress.byte.HB;
+    TBLPTRL = rowAddress.byte.LB;
+
+    for (i = 0; i < FLASH_WRITE_BLOCK_SIZE; i++)
+    {
+        _asm
+        tblrdpostinc
+        _endasm
+        rowBuffer[i] = TABLAT;
+    }
+
+} // RowRead
+
+
+/****************************************************************************
+  Function:
+    void RowProgram ( void )
+
+  Description:
+    Programs the row buffer to Flash at rowAddress with one block write.
+
+  Precondition:
+    The row must have been erased.
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    Execution halts for the duration of the write.
+***************************************************************************/
+
+static void RowProgram ( void )
+{
+    BYTE   *pData;
+    BYTE    i;
+
+    TBLPTRU = rowAddress.byte.UB;
+    TBLPTRH = rowAddress.byte.HB;
+    TBLPTRL = rowAddress.byte.LB;
+
+    // Load the holding registers
+    pData = rowBuffer;
+    for (i = 0; i < FLASH_WRITE_BLOCK_SIZE - 1; i++)
+    {
+        TABLAT = *pData++;
+        _asm
+        tblwtpostinc
+        _endasm
+    }
+    TABLAT = *pData;
+    _asm
+    tblwt                       //Do not increment TBLPTR on the last write.  See datasheet.
+    _endasm
+
+    EECON1 = 0b00000100;        //Block programming mode
+    INTCONbits.GIE = 0;         //Make certain interrupts disabled for unlock process.
+    _asm
+    MOVLW 0x55
+    MOVWF EECON2, 0
+    MOVLW 0xAA
+    MOVWF EECON2, 0
+    BSF EECON1, 1, 0            //Initiates write operation (halts CPU execution until complete)
+    _endasm
+
+    //Good practice now to clear the WREN bit, as further protection against any
+    //   future accidental activation of self write/erase operations.
+    EECON1bits.WREN = 0;
+
+} // RowProgram
+
+
+//******************************************************************************
+//******************************************************************************
+// Loader Flash Programming Interface
+//******************************************************************************
+//******************************************************************************
+
+/****************************************************************************
+  Function:
+    void Loader_RowInit ( void )
+
+  Description:
+    Empties the row buffer and marks all erase blocks as not erased before
+    an image is loaded.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    None
+***************************************************************************/
+
+void Loader_RowInit ( void )
+{
+    rowPending = FALSE;
+    TrackPageEraseInit();
+
+#ifdef LOADER_SKIP_UNCHANGED
+    memset(flashBlockUsed, 0, sizeof(flashBlockUsed));
+    memset(flashBlockChanged, 0, sizeof(flashBlockChanged));
+#endif
+
+} // Loader_RowInit
+
+
+/****************************************************************************
+  Function:
+    void Loader_RowWrite ( DWORD address, BYTE *pData, BYTE length )
+
+  Description:
+    Copies decoded image data into the row buffer.  When the data moves on
+    to another row, the buffered row is programmed to Flash first.
+
+  Precondition:
+    Loader_RowInit must have been called.
+
+  Parameters:
+    address     - Program memory address of the first byte
+    pData       - Pointer to the data
+    length      - Number of bytes
+
+  Returns:
+    None
+
+  Remarks:
+    PROGRAM_FLASH_BASE and PROGRAM_FLASH_END are row aligned, so the range
+    check is made once per row.  With LOADER_SKIP_UNCHANGED, data for blocks
+    that Loader_RowCompare found unchanged is dropped.
+***************************************************************************/
+
+void Loader_RowWrite ( DWORD address, BYTE *pData, BYTE length )
+{
+    DWORD   row;        // Address of the row holding address
+    BYTE    offset;     // Position of address in the row
+    BYTE    count;      // Number of bytes that go to this row
+
+    while (length > 0)
+    {
+        row    = address & ~(DWORD)(FLASH_WRITE_BLOCK_SIZE - 1);
+        offset = (BYTE)address & (FLASH_WRITE_BLOCK_SIZE - 1);
+        count  = FLASH_WRITE_BLOCK_SIZE - offset;
+        if (count > length)
+        {
+            count = length;
+        }
+
+    #ifdef LOADER_SKIP_UNCHANGED
+        if (row >= PROGRAM_FLASH_BASE && row < PROGRAM_FLASH_END && BlockTest(flashBlockChanged, row))
+    #else
+        if (row >= PROGRAM_FLASH_BASE && row < PROGRAM_FLASH_END)
+    #endif
+        {
+            if (!rowPending || row != rowAddress.Val)
+            {
+                Loader_RowFlush();
+
+                if (!TrackPageEraseTest(row))
+                {
+                    BlockErase(row);
+                    TrackPageErase(row, PAGE_ERASED);
+                }
+
+                rowAddress.Val = row;
+                RowRead();
+                rowPending = TRUE;
+            }
+
+            memcpy(&rowBuffer[offset], pData, count);
+        }
+
+        address += count;
+        pData   += count;
+        length  -= count;
+    }
+
+} // Loader_RowWrite
+
+
+/****************************************************************************
+  Function:
+    void Loader_RowFlush ( void )
+
+  Description:
+    Programs the buffered row, if any, to Flash.
+
+  Precondition:
+    Loader_RowInit must have been called.
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    Must be called at the end of the image.
+***************************************************************************/
+
+void Loader_RowFlush ( void )
+{
+    if (rowPending)
+    {
+        RowProgram();
+        rowPending = FALSE;
+    }
+
+} // Loader_RowFlush
+
+
+/****************************************************************************
+  Function:
+    void Loader_RowCompare ( DWORD address, BYTE *pData, BYTE length )
+
+  Description:
+    Compares decoded image data with the current Flash contents and marks
+    the erase blocks that differ, so that Loader_RowWrite only programs 
+    those blocks.
+
+  Precondition:
+    Loader_RowInit must have been called.  The whole image must be compared
+    before any of it is written.
+
+  Parameters:
+    address     - Program memory address of the first byte
+    pData       - Pointer to the data
+    length      - Number of bytes
+
+  Returns:
+    None
+
+  Remarks:
+    Only used if LOADER_SKIP_UNCHANGED is defined.  Bytes of a block that 
+    the image does not give are not compared.
+***************************************************************************/
+
+#ifdef LOADER_SKIP_UNCHANGED
+
+void Loader_RowCompare ( DWORD address, BYTE *pData, BYTE length )
+{
+    DWORD_VAL   current;    // Address being compared
+    DWORD       row;        // Address of the row holding current
+    BYTE        count;      // Number of bytes that go to this row
+    BYTE        i;
+
+    current.Val = address;
+    while (length > 0)
+    {
+        row   = current.Val & ~(DWORD)(FLASH_WRITE_BLOCK_SIZE - 1);
+        count = FLASH_WRITE_BLOCK_SIZE - ((BYTE)current.Val & (FLASH_WRITE_BLOCK_SIZE - 1));
+        if (count > length)
+        {
+            count = length;
+        }
+
+        if (row >= PROGRAM_FLASH_BASE && row < PROGRAM_FLASH_END)
+        {
+            BlockSet(flashBlockUsed, row);
+
+            // Once a block differs there is no need to look at the rest of it
+            if (!BlockTest(flashBlockChanged, row))
+            {
+                TBLPTRU = current.byte.UB;
+                TBLPTRH = current.byte.HB;
+                TBLPTRL = current.byte.LB;
+
+                for (i = 0; i < count; i++)
+                {
+                    _asm
+                    tblrdpostinc
+                    _endasm
+                    if (TABLAT != pData[i])
+                    {
+                        BlockSet(flashBlockChanged, row);
+                        break;
+                    }
+                }
+            }
+        }
+
+        current.Val += count;
+        pData       += count;
+        length      -= count;
+    }
+
+} // Loader_RowCompare
+
+#endif
+
+
+/****************************************************************************
+  Function:
+    void Loader_ClearData ( void )
+
+  Description:
+    Erases the blocks from LOADER_CLEAR_BASE to LOADER_CLEAR_END that the
+    image did not write to, so the new application starts without the data
+    the old one kept there.
+
+  Precondition:
+    The whole image has been programmed and Loader_RowFlush called.
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    Blocks that are already blank are not erased.  Does nothing if 
+    LOADER_CLEAR_BASE is not defined.
+***************************************************************************/
+
+void Loader_ClearData ( void )
+{
+#ifdef LOADER_CLEAR_BASE
+    DWORD_VAL   block;
+    WORD        i;
+
+    for (block.Val = LOADER_CLEAR_BASE; block.Val < LOADER_CLEAR_END; block.Val += FLASH_BLOCK_SIZE)
+    {
+    #ifdef LOADER_SKIP_UNCHANGED
+        if (BlockTest(flashBlockUsed, block.Val))
+    #else
+        if (TrackPageEraseTest(block.Val))
+    #endif
+        {
+            continue;
+        }
+
+        TBLPTRU = block.byte.UB;
+        TBLPTRH = block.byte.HB;
+        TBLPTRL = block.byte.LB;
+
+        for (i = 0; i < FLASH_BLOCK_SIZE; i++)
+        {
+            _asm
+            tblrdpostinc
+            _endasm
+            if (TABLAT != BLOCK_FILL_DEFAULT)
+            {
+                BlockErase(block.Val);
+                break;
+            }
+        }
+    }
+#endif
+
+} // Loader_ClearData
+
+
+/****************************************************************************
+  Function:
+    BYTE Loader_BlocksProgrammed ( void )
+    BYTE Loader_BlocksSkipped ( void )
+
+  Description:
+    Give the number of erase blocks that were erased and programmed, and 
+    the number of blocks the image writes to that already held the image 
+    data and were left alone.
+
+  Precondition:
+    The image has been loaded.
+
+  Parameters:
+    None
+
+  Returns:
+    Number of erase blocks
+
+  Remarks:
+    Loader_BlocksSkipped is always 0 if LOADER_SKIP_UNCHANGED is not 
+    defined.
+***************************************************************************/
+
+BYTE Loader_BlocksProgrammed ( void )
+{
+    DWORD   block;
+    BYTE    count = 0;
+
+    for (block = PROGRAM_FLASH_BASE; block < PROGRAM_FLASH_END; block += FLASH_BLOCK_SIZE)
+    {
+        if (TrackPageEraseTest(block))
+        {
+            count++;
+        }
+    }
+    return count;
+
+} // Loader_BlocksProgrammed
+
+
+BYTE Loader_BlocksSkipped ( void )
+{
+    BYTE    count = 0;
+
+#ifdef LOADER_SKIP_UNCHANGED
+    DWORD   block;
+
+    for (block = PROGRAM_FLASH_BASE; block < PROGRAM_FLASH_END; block += FLASH_BLOCK_SIZE)
+    {
+        if (BlockTest(flashBlockUsed, block) && !BlockTest(flashBlockChanged, block))
+        {
+            count++;
+        }
+    }
+#endif
+    return count;
+
+} // Loader_BlocksSkipped
+
+
+/*
+*******************************************************************************
+EOF
+*******************************************************************************
+*/
@@ -36,8 +36,8 @@ DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
 #include "GenericTypedefs.h"
 #include "HardwareProfile.h"
 #include "boot.h"
-#include "MDD File System\FSIO.h"
 #include "Compiler.h"
+#include <string.h>
 
 
 //******************************************************************************
@@ -46,7 +46,7 @@ DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
 //******************************************************************************
 //******************************************************************************
 
-// Record status codes
+// Record status codes (returned by the optional record type support)
 #define RECORD_DATA                     0   // Data record found
 #define RECORD_FOUND          RECORD_DATA   // Alias for RECORD_DATA
 #define RECORD_NON_DATA                 1   // Identified non-data record
@@ -56,7 +56,39 @@ DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
 #define RECORD_CHECKSUM_ERR            12   // Record was corrupted
 
 // Record buffer array size
-#define MAX_RECORD_LENGTH             16   // Max Hex-Record Length (converted)
+#ifndef MAX_RECORD_LENGTH
+    #define MAX_RECORD_LENGTH          32   // Max Hex-Record Length (converted)
+#endif
+
+// Record types
+#define RECORD_TYPE_DATA             0x00
+#define RECORD_TYPE_EOF              0x01
+#define RECORD_TYPE_SEGMENT_ADDRESS  0x02
+#define RECORD_TYPE_LINEAR_ADDRESS   0x04
+
+// Record byte positions: length, load offset (2), type, then the data
+// payload followed by the checksum
+#define RECORD_INDEX_LENGTH             0
+#define RECORD_INDEX_OFFSET_HIGH        1
+#define RECORD_INDEX_OFFSET_LOW         2
+#define RECORD_INDEX_TYPE               3
+#define RECORD_INDEX_DATA               4
+
+// Parser states
+#define HEX_STATE_START                 0   // Between records, expecting ':'
+#define HEX_STATE_HIGH                  1   // Expecting the first digit of a byte
+#define HEX_STATE_LOW                   2   // Expecting the second digit of a byte
+#define HEX_STATE_EOF                   3   // End of file record seen
+
+// Marks a character that is not a hex digit in hexDigitValue.  Any bit of
+// the upper nibble set means invalid, so several digits can be checked at
+// once by OR-ing their values.
+#define HEX_INVALID                  0xFF
+#define HEX_INVALID_BITS             0xF0
+
+// Number of characters in a record after the ':', for a data payload of
+// length l
+#define RecordChars(l)               (2 * (RECORD_INDEX_DATA + 1 + (l)))
 
 
 //******************************************************************************
@@ -69,14 +101,13 @@ DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
 // This structure holds the translated version of the hex record
 typedef struct
 {
-    unsigned char       RecordLength;   // Length record data payload (adjusted 
-                                        //   if Offset is non-zero).
+    unsigned char       RecordLength;   // Length record data payload
     unsigned int        LoadOffset;     // 16-bit offset to which the data will 
                                         //   be loaded
     unsigned char       RecordType;     // Type of data in the record
-    unsigned char       ValidIndex;     // Indicates first valid byte in a record
 
-    unsigned char       data[MAX_RECORD_LENGTH];      // Record data buffer
+    unsigned char       data[MAX_RECORD_LENGTH + 1];  // Record data buffer
+                                                      //   (and the checksum)
 
 } RECORD_STRUCT; // hexadecimal format data for transfer to aggregator
 
@@ -86,10 +117,44 @@ RECORD_STRUCT   recordBuffer;
 // Base address of current section being written to Flash.
 unsigned long int baseAddress = 0;
 
+// Parser state, kept from one piece of the file to the next
+BYTE            hexState;       // HEX_STATE_xxx
+BYTE            hexIndex;       // Position of the next byte in the record
+BYTE            hexHigh;        // First digit of the byte being decoded
+BYTE            hexSum;         // Sum of the record bytes so far
+
+// Receives the data of each valid data record
+LOADER_SINK     hexSink;
+
+// Value of each character as a hex digit
+#define BAD     HEX_INVALID
+rom BYTE hexDigitValue[256] =
+{
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0x00
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0x10
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0x20
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0x30
+    BAD,  0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0x40
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0x50
+    BAD,  0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0x60
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0x70
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0x80
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0x90
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0xA0
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0xB0
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0xC0
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0xD0
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,    // 0xE0
+    BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD,  BAD     // 0xF0
+};
+#undef BAD
+
+#define HexNibble(c)    (hexDigitValue[(BYTE)(c)])
+
 // Flash block erasure tracking
 //
 // Each bit represents one Flash block.  Assumes an unsigned long int has 32 bits.
-unsigned long int flashPageStatus[1];
+unsigned long int flashPageStatus[(NUMBER_OF_FLASH_BLOCKS + 31) / 32];
 
 
 //******************************************************************************
@@ -159,7 +224,7 @@ BOOL TrackPageEraseTest(unsigned long int PageAddress)
     // Note:  Each bit tracks 1 page so each word tracks 32 pages
     //   Word position = PageNumber / 32
     //   Bit  position = PageNumber % 32
-    if ( flashPageStatus[PageNumber/32] & (1 << (PageNumber%32)) )
+    if ( flashPageStatus[PageNumber/32] & (1UL << (PageNumber%32)) )
     {
         // page has been erased
         return TRUE;
@@ -198,10 +263,6 @@ BOOL TrackPageEraseTest(unsigned long int PageAddress)
     
 ***************************************************************************/
 
-// Parameter flags definitions
-#define PAGE_ERASED         TRUE
-#define PAGE_NOT_ERASED     FALSE
-
 void TrackPageErase(unsigned long int PageAddress, BOOL PageErased)
 {
     unsigned long int PageNumber;
@@ -217,12 +278,12 @@ void TrackPageErase(unsigned long int PageAddress, BOOL PageErased)
     if (PageErased)
     {
         // Set the bit to indicate the page has been erased
-        flashPageStatus[PageNumber/32] |=  ( 1 << (PageNumber % 32) );
+        flashPageStatus[PageNumber/32] |=  ( 1UL << (PageNumber % 32) );
     }
     else
     {
         // Clear the bit to indicate the page needs to be erased
-        flashPageStatus[PageNumber/32] &= ~( 1 << (PageNumber % 32) );
+        flashPageStatus[PageNumber/32] &= ~( 1UL << (PageNumber % 32) );
     }
 
 } //TrackPageErase
@@ -230,383 +291,395 @@ void TrackPageErase(unsigned long int PageAddress, BOOL PageErased)
 
 /****************************************************************************
   Function:
-    unsigned char AsciiToHexNibble(unsigned char data)
-    
+    BYTE ProcessRecord ( RECORD_STRUCT *pRecord )
+
   Description:
-    Converts an ASCII byte in the range of "0 - 9", "A - F", or "a - f" to a 
-    hex nibble
+    Executes the command for each hexfile record type.
     
   Precondition:
-    None
+    pRecord must contain a record with a valid checksum
 
   Parameters:
-    data            - char containing the data to convert
-    
+    pRecord                 - Pointer to the record
+
   Returns:
-    hex value represented by the input ASCII character (0x00 - 0x0F)
-    0 for input values out of range.
+    LOADER_NEED_DATA        - Record done, the file continues
+    LOADER_EOF              - Last record in the file
+    LOADER_DECODE_ERROR     - Record refused by the optional record type
+                              support
 
   Remarks:
-     Example:         value = AsciiToHexNibble('A'); // value = 0x0A
+    Start address records, and other records the loader does not use, are
+    ignored.
 ***************************************************************************/
 
-unsigned char AsciiToHexNibble(unsigned char data)
+static BYTE ProcessRecord ( RECORD_STRUCT *pRecord )
 {
-    if (data < '0')                     // return 0 for an invalid characters
-    {
-        return 0;
-    }
-    else if (data <= '9')               // handle numbers
-    {
-        return ( data - '0' );
-    }
-    else if (data < 'A')
-    {
-        return 0;
-    }
-    else if (data <= 'F')               // handle uppercase letters
-    {
-        return ( data - 'A' + 10 );
-    }
-    else if (data < 'a')
-    {
-        return 0;
-    }
-    else if (data <= 'f')               // handle lowercase letters
-    {
-        return ( data - 'a' + 10 );
-    }
-    else
+    switch (pRecord->RecordType)
     {
-        return 0;
-    }
-
-} // AsciiToHexNibble
+    
+    case RECORD_TYPE_DATA:
+        hexSink(baseAddress + pRecord->LoadOffset, pRecord->data, pRecord->RecordLength);
+        break;
+    
+    case RECORD_TYPE_EOF:
+        return LOADER_EOF;
+    
+    case RECORD_TYPE_SEGMENT_ADDRESS:
+        // Bits 4 to 19 of the address
+        baseAddress = ((unsigned long int)pRecord->data[0] << 8) | pRecord->data[1];
+        baseAddress = baseAddress << 4;
+        break;
+    
+    case RECORD_TYPE_LINEAR_ADDRESS:
+        // Upper 16 bits of the address
+        baseAddress = ((unsigned long int)pRecord->data[0] << 8) | pRecord->data[1];
+        baseAddress = baseAddress << 16;
+        break;
 
+    #ifdef EXTENDED_HEXFILE_SUPPORT // non-Intel commands
+                
+    case 0x10: // serial number
+        // Only allow programming if the stored SN matches the one stored in the file
+        if (Loader_ValidateSerialNumber(pRecord->data, pRecord->RecordLength) != RECORD_NON_DATA)
+        {
+            return LOADER_DECODE_ERROR;
+        }
+        break;
 
-/****************************************************************************
-  Function:
-    unsigned char AsciiToHexByte ( unsigned char m, unsigned char, l )
+    case 0x11: // revision number
+        // Intended to  only allow programming if current revision is 
+        // lower than the one contained in the file
+        if (Loader_ValidateRevisionNumber(pRecord->data, pRecord->RecordLength) != RECORD_NON_DATA)
+        {
+            return LOADER_DECODE_ERROR;
+        }
+        break;
 
-  Description:
-    Converts two ASCII characters representing hex nibbles into a single
-    hex (or binary) byte.
+    case 0x12: // Check Error Detection Accumulator (csum, CRC, MD-5, etc)
+        if (Loader_CheckErrorDetection(pRecord->data, pRecord->RecordLength) != RECORD_NON_DATA)
+        {
+            return LOADER_DECODE_ERROR;
+        }
+        break;
+            
+    #endif
     
-  Precondition:
-    None
-
-  Parameters:
-    m           - Most significant nibble (in ASCII-hex representation)
-    l           - Least significant nibble (in ASCII-hex representation)
-
-  Returns:
-    1-byte hex (binary) value represented by the two ASCII nibbles
+    default:
+        break;
 
-  Remarks:
-    Implemented as a macro
-***************************************************************************/
+    } // switch
+    
+    return LOADER_NEED_DATA;
 
-#define AsciiToHexByte(m,l) ( (AsciiToHexNibble(m) << 4 ) | AsciiToHexNibble(l) )
+} // ProcessRecord
 
 
 /****************************************************************************
   Function:
-    unsigned int FindHexRecord ( char *pBufferData, unsigned int nSize )
+    BYTE RecordByte ( BYTE value )
 
   Description:
-    Scans the specified buffer from start to end seeking the start of 
-    record charactor (':') and provides the position of the first byte of 
-    the record (past the start character).
+    Adds the next decoded byte to the record being parsed.  After the
+    checksum byte the record is checked and processed.
     
   Precondition:
-    None
+    hexSum already includes value
 
   Parameters:
-    pBufferData     - Pointer to buffer
-    nSize           - Size of the buffer in bytes
+    value                   - Decoded byte
 
   Returns:
-    Postion starting position record (next byte after the start of record
-    character ':').  If the return value is greater or equal to the size of
-    the given buffer, no record was found.
+    LOADER_NEED_DATA        - The record or the file continues
+    LOADER_EOF              - End of file record processed
+    LOADER_DECODE_ERROR     - Record too long, checksum mismatch, or refused
 
   Remarks:
-    None
+  Record format:
+    +--------------------------------------------------------------+
+    | ':' | RecLen | Load Offset | RecType | Data Payload | ChkSum |
+    +--------------------------------------------------------------+
+            0        1      2        3       4 ...          4 + RecLen
 ***************************************************************************/
 
-unsigned int FindHexRecord ( char *pBufferData, unsigned int nSize )
+static BYTE RecordByte ( BYTE value )
 {
-    unsigned int position;  // Position of record in buffer
-    
-    // Scan the buffer for the start-of-record character
-    for (position = 0; position < nSize; position++)
+    BYTE    index;
+
+    index = hexIndex++;
+    switch (index)
     {
-        if ( pBufferData[position] == ':' )
+    case RECORD_INDEX_LENGTH:
+        if (value > MAX_RECORD_LENGTH)
         {
-            // Skip the start-of-record character
-            position++;
+            return LOADER_DECODE_ERROR;
+        }
+        recordBuffer.RecordLength = value;
+        break;
+
+    case RECORD_INDEX_OFFSET_HIGH:
+        recordBuffer.LoadOffset = (unsigned int)value << 8;
+        break;
+
+    case RECORD_INDEX_OFFSET_LOW:
+        recordBuffer.LoadOffset |= value;
+        break;
+
+    case RECORD_INDEX_TYPE:
+        recordBuffer.RecordType = value;
+        break;
+
+    default:
+        index -= RECORD_INDEX_DATA;
+        if (index < recordBuffer.RecordLength)
+        {
+            recordBuffer.data[index] = value;
             break;
         }
+
+        // Checksum: all record bytes add up to 0
+        hexState = HEX_STATE_START;
+        if (hexSum != 0)
+        {
+            BLIO_ReportBootStatus(LOADER_CHECKSUM_ERR, "BL Loader: Error - Hex record checksum mismatch\r\n");
+            return LOADER_DECODE_ERROR;
+        }
+        return ProcessRecord(&recordBuffer);
     }
-    return (position);
 
-} // FindRecord
+    return LOADER_NEED_DATA;
+
+} // RecordByte
 
 
 /****************************************************************************
   Function:
-    void RecordInitialize( RECORD_STRUCT *pRecord )
+    BYTE DecodeRecord ( BYTE *pChars )
 
   Description:
-    Initializes a Record structure
+    Decodes, checks and processes a whole record at once.  This is the fast
+    path for records that are complete in the read buffer, which is nearly
+    all of them.
     
   Precondition:
-    None
+    pChars points to the first character after the ':', and all
+    RecordChars() characters of the record are in the buffer.  The record
+    length is valid (not above MAX_RECORD_LENGTH).
 
   Parameters:
-    pRecord     - Pointer to the record data structure
+    pChars                  - Pointer to the record characters
 
   Returns:
-    None
+    LOADER_NEED_DATA        - Record done, the file continues
+    LOADER_EOF              - End of file record processed
+    LOADER_DECODE_ERROR     - Invalid digit, checksum mismatch, or refused
 
   Remarks:
-    Implemented as a macro
+    Digits are only checked once, after the loops.
 ***************************************************************************/
 
-#define RecordInitialize(r)    ((r)->RecordLength = 0,(r)->ValidIndex = 0)
+static BYTE DecodeRecord ( BYTE *pChars )
+{
+    BYTE    header[RECORD_INDEX_DATA];
+    BYTE   *pValue;
+    BYTE    high, low;
+    BYTE    invalid = 0;
+    BYTE    sum = 0;
+    BYTE    count;
+
+    // Length, load offset and type
+    pValue = header;
+    for (count = RECORD_INDEX_DATA; count > 0; count--)
+    {
+        high      = HexNibble(*pChars++);
+        low       = HexNibble(*pChars++);
+        invalid  |= high | low;
+        *pValue   = (high << 4) | low;
+        sum      += *pValue++;
+    }
+
+    // Data payload and checksum
+    pValue = recordBuffer.data;
+    for (count = header[RECORD_INDEX_LENGTH] + 1; count > 0; count--)
+    {
+        high      = HexNibble(*pChars++);
+        low       = HexNibble(*pChars++);
+        invalid  |= high | low;
+        *pValue   = (high << 4) | low;
+        sum      += *pValue++;
+    }
+
+    if (invalid & HEX_INVALID_BITS)
+    {
+        return LOADER_DECODE_ERROR;
+    }
+
+    if (sum != 0)
+    {
+        BLIO_ReportBootStatus(LOADER_CHECKSUM_ERR, "BL Loader: Error - Hex record checksum mismatch\r\n");
+        return LOADER_DECODE_ERROR;
+    }
+
+    recordBuffer.RecordLength = header[RECORD_INDEX_LENGTH];
+    recordBuffer.LoadOffset   = ((unsigned int)header[RECORD_INDEX_OFFSET_HIGH] << 8) | header[RECORD_INDEX_OFFSET_LOW];
+    recordBuffer.RecordType   = header[RECORD_INDEX_TYPE];
+    return ProcessRecord(&recordBuffer);
 
+} // DecodeRecord
+
+
+//******************************************************************************
+//******************************************************************************
+// Hex Loader Interface
+//******************************************************************************
+//******************************************************************************
 
 /****************************************************************************
   Function:
-    unsigned char ProcessRecord( RECORD_STRUCT *pRecord )
+    void Loader_HexInit ( LOADER_SINK sink )
 
   Description:
-    Executes the command for each hexfile record type.
-    
+    Prepares to parse a hex file from its first character.
+
   Precondition:
-    pRecord must contain valid record data
+    None
 
   Parameters:
-    pRecord               - Pointer to the record
+    sink        - Routine that receives the data of each data record
 
   Returns:
-    RECORD_DATA           - Data record found
-    RECORD_NON_DATA       - Identified non-data record
-    RECORD_EOF            - Last record in the file
-    RECORD_NOT_FOUND      - No record found
-    RECORD_UNSUPPORTED    - Unable to identify record type
-    RECORD_CHECKSUM_ERR   - Record was corrupted
+    None
 
   Remarks:
     None
 ***************************************************************************/
 
-unsigned char ProcessRecord( RECORD_STRUCT *pRecord )
+void Loader_HexInit ( LOADER_SINK sink )
 {
-    // executes command from the hex file line
-    unsigned char   returnVal = 0;
-        
-    switch (pRecord->RecordType)
-    {
-    
-    case 0x00: // data entry
-        returnVal = RECORD_DATA;
-        break;
-    
-    case 0x01: // end of file
-        // this was the last record in the hexfile
-        RecordInitialize(pRecord);
-        returnVal = RECORD_EOF; 
-        break;
-    
-    case 0x02: // Extended segment address record
-        RecordInitialize(pRecord);
-        returnVal = RECORD_UNSUPPORTED;
-        break;
-    
-    case 0x03: // Start Segment Address record
-        RecordInitialize(pRecord);
-        returnVal = RECORD_UNSUPPORTED;
-        break;
-    
-    case 0x04: // Extended Linear Address record
-        // set upper 16bits to value from record, lower 16bits are forced to 0 ** update to point to ULBA
-        baseAddress = (pRecord->data[0] << 8) | pRecord->data[1];
-        baseAddress = baseAddress << 16;
-        RecordInitialize(pRecord);
-        returnVal   = RECORD_NON_DATA;
-        break;
-    
-    case 0x05: // Start Linear Address record
-        RecordInitialize(pRecord);
-        returnVal = RECORD_UNSUPPORTED;
-        break;
+    hexState    = HEX_STATE_START;
+    hexSink     = sink;
+    baseAddress = 0;
 
-    #ifdef EXTENDED_HEXFILE_SUPPORT // non-Intel commands
-                
-    // If this mode is not enabled extened commands will generate 
-    // unsupported hexfile command errors(messages), they will be ignored
-
-    case 0x10: // serial number
-        // Only allow programming if the stored SN matches the one stored in the file
-        returnVal = Loader_ValidateSerialNumber(pRecord->data, pRecord->RecordLength);
-        RecordInitialize(pRecord);
-        break;
-
-    case 0x11: // revision number
-        // Intended to  only allow programming if current revision is 
-        // lower than the one contained in the file
-        returnVal = Loader_ValidateRevisionNumber(pRecord->data, pRecord->RecordLength);
-        RecordInitialize(pRecord);
-        break;
-
-    case 0x12: // Check Error Detection Accumulator (csum, CRC, MD-5, etc)
-        returnVal = Loader_CheckErrorDetection(pRecord->data, pRecord->RecordLength);
-        RecordInitialize(pRecord);
-        break;
-            
-    #endif
-    
-    default:
-        RecordInitialize(pRecord);
-        returnVal = RECORD_UNSUPPORTED;
-        break;
-
-    } // switch
-    
-    return (returnVal);
-
-} //DecodeHexFileCommand()
+} // Loader_HexInit
 
 
 /****************************************************************************
   Function:
-    unsigned int GetRecord( RECORD_STRUCT *pOutputBuffer,  
-                            unsigned int  *nInput, 
-                            BYTE          *pInputBuffer ) 
+    BYTE Loader_HexDecode ( BYTE *pData, WORD length )
 
   Description:
-    Takes data from raw hex buffer and translates it into a record structure
-    
+    Parses the next piece of a hex file.  Records may be split between 
+    pieces anywhere.  Each record is checked before it is used, and the 
+    data of each data record goes to the sink.
+
   Precondition:
-    The pInputBuffer must point to nInput bytes of hex-record format data.
+    Loader_HexInit must have been called.
 
   Parameters:
-    pOutputBuffer       - Pointer to a record structure
-    nInput              - Number of bytes of raw data available (updated)
-    pInputBuffer        - Pointer to input data buffer
+    pData       - Pointer to the data read from the hex file
+    length      - Number of bytes
 
   Returns:
-    RECORD_FOUND        - Record found, translated, placed in output buffer,
-                          and "removed" from input buffer
-    RECORD_NOT_FOUND    - No record found, no data removed from input buffer
-    RECORD_CHECKSUM_ERR - Record was corrupted
-    
-  Note:  
-    If RECORD_FOUND is returned, *nInput will be reduced by the number of 
-    ASCII bytes that made up the record (plus any preceeding bytes).
-  
-  Record format:
-    +--------------------------------------------------------------+
-    | ':' | RecLen | Load Offset | RecType | Data Payload | ChkSum |
-    +--------------------------------------------------------------+
-      -1  | 0   1  | 2  3  4  5  | 6   7   | 0 ...  n*2  | +0  +1  |
-      
+    LOADER_NEED_DATA        - The file continues in the next piece
+    LOADER_EOF              - End of file record reached
+    LOADER_DECODE_ERROR     - The file is not a valid hex file
+
+  Remarks:
+    Carriage returns and line feeds are allowed between records.  Anything
+    after the end of file record is ignored.  Records that are complete in
+    the piece are decoded in one go by DecodeRecord; the state machine only
+    handles records split between pieces.
 ***************************************************************************/
 
-unsigned int GetRecord( RECORD_STRUCT *pOutputBuffer,  unsigned int *nInput, BYTE *pInputBuffer ) 
+BYTE Loader_HexDecode ( BYTE *pData, WORD length )
 {
-    unsigned char   Sum = 0;                // Accumulated sum of translated bytes
-    unsigned char   Temp;                   // Used for MSB of multi-byte values
-    unsigned char   iData;                  // Data payload index variable
-    unsigned int    nUsed;                  // Number of input buffer data bytes used
-    unsigned char   RecordLength;           // Length record data payload
-    unsigned int    LoadOffset;             // 16-bit offset to which the data will be loaded
-    unsigned char   RecordType;             // Type of data in the record
-    unsigned char   Checksum;               // Checksum given in the record
-
-    // Check to make sure the record buffer is empty
-    if ( pOutputBuffer->RecordLength - pOutputBuffer->ValidIndex > 0 )
-    {
-        return RECORD_FOUND;
-    }
+    BYTE    nibble;
+    BYTE    value;
+    BYTE    result;
+    WORD    count;      // Characters in a record after the ':'
 
-    // Make sure we have input data
-    if (*nInput > 0)
+    while (length > 0)
     {
-        // Scan for a start of record
-        nUsed         = FindHexRecord((char*)pInputBuffer, *nInput);
-        pInputBuffer += nUsed;
-
-        // Check to see of we have enough data for a record (10 bytes overhead)
-        if ( nUsed + 8  < *nInput )
+        switch (hexState)
         {
-            //
-            // Translate record and accumulate checksum:
-            //
-
-            // Extract the record length
-            RecordLength  = AsciiToHexByte(pInputBuffer[0], pInputBuffer[1]);
-            Sum          += RecordLength;
-
-            // Extract the load offset
-            Temp          = AsciiToHexByte(pInputBuffer[2], pInputBuffer[3]);
-            Sum          += Temp;
-            LoadOffset    = AsciiToHexByte(pInputBuffer[4], pInputBuffer[5]);
-            Sum          += LoadOffset;
-            LoadOffset   += Temp << 8;
-
-            // Extract the record type
-            RecordType    = AsciiToHexByte(pInputBuffer[6], pInputBuffer[7]);
-            Sum          += RecordType;
-
-            pInputBuffer += 8;
-
-
-            // Make sure the input buffer contains enough data for the payload and checksum
-            nUsed += (2 * RecordLength) + 10;
-            if ( nUsed > *nInput )
+        case HEX_STATE_START:
+            if (*pData == ':')
             {
-                // Insufficient data to form a record
-                return RECORD_NOT_FOUND;
+                // Fast path if the whole record is in the buffer
+                if (length > 2)
+                {
+                    value = (HexNibble(pData[1]) << 4) | HexNibble(pData[2]);
+                    count = RecordChars(value);
+                    if (((HexNibble(pData[1]) | HexNibble(pData[2])) & HEX_INVALID_BITS) == 0 &&
+                        value <= MAX_RECORD_LENGTH && count < length)
+                    {
+                        result = DecodeRecord(pData + 1);
+                        if (result != LOADER_NEED_DATA)
+                        {
+                            if (result == LOADER_EOF)
+                            {
+                                hexState = HEX_STATE_EOF;
+                            }
+                            return result;
+                        }
+                        pData  += count + 1;
+                        length -= count + 1;
+                        continue;
+                    }
+                }
+
+                hexIndex = 0;
+                hexSum   = 0;
+                hexState = HEX_STATE_HIGH;
             }
-
-            // Extract the data payload
-            for (iData=0; iData/2 < RecordLength; iData+=2)
+            else if (*pData != 0x0D && *pData != 0x0A)
             {
-                pOutputBuffer->data[iData/2]  = AsciiToHexByte(pInputBuffer[iData+0], pInputBuffer[iData+1]);
-                Sum                          += pOutputBuffer->data[iData/2];
+                return LOADER_DECODE_ERROR;
             }
+            break;
 
-            pInputBuffer += iData;
-
-
-            // Extract and verify check sum
-            Checksum  = AsciiToHexByte(pInputBuffer[0], pInputBuffer[1]);
-            Sum      += Checksum;
-            if (Sum != 0 )
+        case HEX_STATE_HIGH:
+            nibble = HexNibble(*pData);
+            if (nibble == HEX_INVALID)
             {
-                BLIO_ReportBootStatus(LOADER_CHECKSUM_ERR, "BL Loader: Error - Hex record checksum mismatch\r\n");
-                return RECORD_CHECKSUM_ERR;
+                return LOADER_DECODE_ERROR;
             }
+            hexHigh  = nibble << 4;
+            hexState = HEX_STATE_LOW;
+            break;
 
-            // Checksum valid, "remove" data from input buffer
-            *nInput -= nUsed;
+        case HEX_STATE_LOW:
+            nibble = HexNibble(*pData);
+            if (nibble == HEX_INVALID)
+            {
+                return LOADER_DECODE_ERROR;
+            }
+            value    = hexHigh | nibble;
+            hexSum  += value;
+            hexState = HEX_STATE_HIGH;
 
-            // Fill in the record parameters
-            pOutputBuffer->RecordLength = RecordLength;
-            pOutputBuffer->LoadOffset   = LoadOffset;
-            pOutputBuffer->RecordType   = RecordType;
-            pOutputBuffer->ValidIndex   = 0;
+            result = RecordByte(value);
+            if (result == LOADER_EOF)
+            {
+                hexState = HEX_STATE_EOF;
+            }
+            if (result != LOADER_NEED_DATA)
+            {
+                return result;
+            }
+            break;
 
-            return RECORD_FOUND;
+        default:
+            return LOADER_EOF;
         }
+
+        pData++;
+        length--;
     }
-    
-    // Insufficient data to form a record
-    return RECORD_NOT_FOUND;
 
-} // GetRecord
+    return (hexState == HEX_STATE_EOF) ? LOADER_EOF : LOADER_NEED_DATA;
+
+} // Loader_HexDecode
 
 
 /*
@@ -38,6 +38,7 @@ DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
 #include "boot.h"
 #include "Compiler.h"
 #include "MDD File System\FSIO.h"
+#include "boot_media_sd.h"
 #include "Flash Programming\flash_memory.h"
 #include "oled.h"
 #include <stdio.h>
@@ -138,6 +139,48 @@ BYTE            ReadBuffer[BL_READ_BUFFER_SIZE];
 // Implemented as a macro 
 
 
+/****************************************************************************
+  Function:
+    BOOL IsBlfFile ( char *file_name )
+
+  Description:
+    Checks if a file name has the extension of a binary (BLF) image.
+
+  Precondition:
+    None
+
+  Parameters:
+    file_name - Pointer to a null-terminated file name
+
+  Returns:
+    TRUE      - The file name ends in ".BLF" (any case)
+    FALSE     - Any other file name
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+static BOOL IsBlfFile ( char *file_name )
+{
+    char   *pExtension = NULL;
+
+    while (*file_name != 0)
+    {
+        if (*file_name == '.')
+        {
+            pExtension = file_name + 1;
+        }
+        file_name++;
+    }
+
+    return pExtension != NULL &&
+           (pExtension[0] & 0xDF) == 'B' &&
+           (pExtension[1] & 0xDF) == 'L' &&
+           (pExtension[2] & 0xDF) == 'F' &&
+           pExtension[3] == 0;
+}
+
+
 /****************************************************************************
   Function:
     BOOL BLMedia_LoadFile (  char *file_name )
@@ -162,66 +205,22 @@ BYTE            ReadBuffer[BL_READ_BUFFER_SIZE];
 
   Remarks:
     This routine calls the loader layer to translate and program the boot
-    image file.
+    image file.  Files named *.BLF are binary images (see boot_load_blf.h),
+    any other file is read as Intel HEX.  The file is streamed by the SD
+    card image reader (boot_media_sd.c), which maps where the file is on
+    the card once, then passes each sector to the decoder and has the card
+    read the next one meanwhile.
     
     This routine can be modified to account for differences in how the medium
     and file format must be processed.
   ***************************************************************************/
-#define AsciiToHexByte(m,l) ( (AsciiToHexNibble(m) << 4 ) | AsciiToHexNibble(l) )
-unsigned char AsciiToHexNibble(unsigned char data);
-BYTE recordData[16];
-BYTE recordDataOdd;
-BOOL oddPacketDetected = FALSE;
-
-/*
-typedef enum
-{
-    START_CODE,
-    BYTE_COUNT_B1,
-    BYTE_COUNT_B2,
-    ADDRESS_B1,
-    ADDRESS_B2,
-    ADDRESS_B3,
-    ADDRESS_B4,
-} RECORD_STATE;
-*/
-typedef enum
-{
-    RECORD_TYPE_DATA_RECORD = 0x00,
-    RECORD_TYPE_EOF = 0x01,
-    RECORD_TYPE_EXTENDED_ADDRESS = 0x04
-} RECORD_TYPE;
-
 BOOL BLMedia_LoadFile (  char *file_name )
 {
     FSFILE         *fp;             // File pointer
-    size_t          nBuffer;        // Number of bytes in the read buffer
-    size_t          iBuffer;        // Index into the read buffer
-    unsigned int    nRemaining;     // Number of bytes remaining to decode
-    unsigned int    Result;         // Result code from "GetFlashBlock" operation
-
-    WORD_VAL        byteCountASCII;
-    DWORD_VAL       addressASCII;
-    DWORD_VAL       extendedAddressASCII;
-    WORD_VAL        recordTypeASCII;
-    WORD_VAL        checksumASCII;
-    WORD_VAL        dataByteASCII;
-    DWORD_VAL       totalAddress;
-
-    BYTE_VAL        byteCount;
-    WORD_VAL        address;
-    WORD_VAL        extendedAddress;
-    BYTE_VAL        recordType;
-    BYTE_VAL        checksum;
-    BYTE_VAL        dataByte;
-
-    BYTE            recordDataCounter;
-    BYTE            byteEvenVsOdd;
-
-    WORD            byteCountCopy;
-    WORD*           pData;
-    BYTE            i;
-
+    BYTE            result;         // Result of decoding the file
+    BOOL            binary;         // TRUE for a BLF image, FALSE for hex
+    SD_SECTOR_SINK  decode;         // Decoder for the image format
+    LOADER_SINK     sink;           // Where the decoded image goes
 	BYTE			mode;
 
 	mode = 0x72;	//"r"
@@ -232,342 +231,69 @@ BOOL BLMedia_LoadFile (  char *file_name )
         BLIO_ReportBootStatus(BL_FS_FILE_ERR, "BL: Media Error - Unable to open file\r\n" );
         return FALSE;
     }
-    else
+
+    binary = IsBlfFile(file_name);
+    decode = binary ? Loader_BlfDecode : Loader_HexDecode;
+
+    // With LOADER_SKIP_UNCHANGED the image is read twice: first compared
+    // with Flash, then programmed where it differs.
+#ifdef LOADER_SKIP_UNCHANGED
+    sink = Loader_RowCompare;
+#else
+    sink = Loader_RowWrite;
+#endif
+
+    Loader_RowInit();
+    BLSd_StartTiming();
+
+    // Find where the file is on the card, once for both passes
+    if (!BLSd_MapFile(fp))
+    {
+        BLIO_ReportBootStatus(BL_FS_FILE_ERR, "BL: Media Error - Unable to read file\r\n" );
+        FSfclose( fp );
+        return FALSE;
+    }
+
+    // Read the file and program it to Flash
+    while(1)
     {
-        for(totalAddress.Val=PROGRAM_FLASH_BASE;totalAddress.Val<(PROGRAM_FLASH_END);totalAddress.Val+=FLASH_BLOCK_SIZE)
+        if (binary)
+        {
+            Loader_BlfInit(sink);
+        }
+        else
         {
-			TBLPTRL = totalAddress.byte.LB;
-			TBLPTRH = totalAddress.byte.HB;
-			TBLPTRU = totalAddress.byte.UB;
-
-			EECON1 = 0b00010100;
-		
-			INTCONbits.GIE = 0;	//Make certain interrupts disabled for unlock process.
-			_asm
-			MOVLW 0x55
-			MOVWF EECON2, 0
-			MOVLW 0xAA
-			MOVWF EECON2, 0
-			BSF EECON1, 1, 0
-			_endasm
-		
-		    //Good practice now to clear the WREN bit, as further protection against any
-			//	 future accidental activation of self write/erase operations.
-			EECON1bits.WREN = 0;
+            Loader_HexInit(sink);
         }
 
-        // Read the file and program it to Flash
-        iBuffer     = 0;
-        nRemaining  = 0;
-        nBuffer     = 0;
+        result = BLSd_StreamFile(&ReadBuffer[0], decode);
 
-        while(1)
+        if(result == LOADER_NEED_DATA)
         {
-            if(nRemaining == 0)
-            {
-                nRemaining = FSfread(&ReadBuffer[0], 1, BL_READ_BUFFER_SIZE, fp );
-		        if(nRemaining == 0)
-                {   
-                    //unable to read data from the file
-                    FSfclose( fp );
-                    return FALSE;
-                }
-                iBuffer = 0;
-            }
-
-            switch(nBuffer)
-            {
-                case 0: //start code
-                    if(ReadBuffer[iBuffer] != ':')
-                    {
-                        //ignore line feeds and line returns
-                        if((ReadBuffer[iBuffer] != 0x0D) || (ReadBuffer[iBuffer] != 0x0A))
-                        {
-                            iBuffer++; 
-                            nRemaining--;
-                            //end of line of the last line
-                            continue;
-                        }
-                        else
-                        {
-                            FSfclose( fp );
-                            return FALSE;
-                        }
-                    }    
-                    iBuffer++;        
-                    break;
-                case 1: //byte count byte 1
-                    byteCountASCII.v[1] = ReadBuffer[iBuffer++];
-                    break;
-                case 2: //byte count byte 2
-                    byteCountASCII.v[0] = ReadBuffer[iBuffer++];
-                    byteCount.Val = AsciiToHexByte(byteCountASCII.v[1],byteCountASCII.v[0]);
-                    byteCountCopy = byteCount.Val;
-                    byteEvenVsOdd = 0;
-                    recordDataCounter = 0;
-                    break;
-                case 3: //address byte 1
-                    addressASCII.v[3] = ReadBuffer[iBuffer++];
-                    break;
-                case 4: //address byte 2
-                    addressASCII.v[2] = ReadBuffer[iBuffer++];
-                    break;
-                case 5: //address byte 3
-                    addressASCII.v[1] = ReadBuffer[iBuffer++];
-                    break;
-                case 6: //address byte 4
-                    addressASCII.v[0] = ReadBuffer[iBuffer++];
-                    address.v[0] = AsciiToHexByte(addressASCII.v[1],addressASCII.v[0]);
-                    address.v[1] = AsciiToHexByte(addressASCII.v[3],addressASCII.v[2]);
-                    break;
-                case 7: //record type byte 1
-                    recordTypeASCII.v[1] = ReadBuffer[iBuffer++];
-                    break;
-                case 8: //record type byte 2
-                    recordTypeASCII.v[0] = ReadBuffer[iBuffer++];
-                    recordType.Val = AsciiToHexByte(recordTypeASCII.v[1],recordTypeASCII.v[0]);
-                    break;
-                case 9: //data
-                    if(byteCountCopy != 0)
-                    {
-                        if(byteEvenVsOdd == 0)
-                        {
-                            dataByteASCII.v[1] = ReadBuffer[iBuffer++];
-                            byteEvenVsOdd = 1;
-                        }
-                        else
-                        {
-                            dataByteASCII.v[0] = ReadBuffer[iBuffer++];
-                            dataByte.Val = AsciiToHexByte(dataByteASCII.v[1],dataByteASCII.v[0]);
-                            recordData[recordDataCounter++] = dataByte.Val;
-                            byteCountCopy--;
-                            byteEvenVsOdd = 0;
-                        }
-                        break;
-                    }
-                    else
-                    {
-                        nBuffer = 10;
-                    }
-                case 10: //checksum byte 1
-                    checksumASCII.v[1] = ReadBuffer[iBuffer++];
-                    break;
-                case 11: //checksum byte 2
-                    checksumASCII.v[0] = ReadBuffer[iBuffer++];
-                    checksum.Val = AsciiToHexByte(checksumASCII.v[1],checksumASCII.v[0]);
-
-                    switch(recordType.Val)
-                    {
-                        case RECORD_TYPE_DATA_RECORD:
-                            //check the address here
-                            totalAddress.word.HW = extendedAddress.Val;
-                            totalAddress.word.LW = address.Val;
-
-                            if(totalAddress.Val == 0xD310)
-                            {
-                                Nop();
-                            }
-
-                            if(totalAddress.Val < PROGRAM_FLASH_BASE)
-                            {
-                                //invalid address - below base - don't program the requested address
-                                break;
-                            }
-
-                            if(totalAddress.Val >= PROGRAM_FLASH_END)
-                            {
-                                break;
-                            }
-			        
-							if (byteCount.Val & 0x01)
-							{
-								/* Odd number of bytes was read! */
-								/* If the previous number of bytes was even, than we need to keep the  
-									last byte for the next line and to decrease byteCount*/
-								if (oddPacketDetected == FALSE)
-								{
-									oddPacketDetected = TRUE;
-								}								
-							}
-							else
-							{
-									oddPacketDetected = FALSE;
-							}
-
-							for(i=0;byteCount.Val-i>1;i++)
-					        {                        	
-                                if(totalAddress.byte.LB & 0x01)
-                                {
-                                    totalAddress.Val--;
-
-    								TBLPTRL = totalAddress.byte.LB;
-    								TBLPTRH = totalAddress.byte.HB;
-    								TBLPTRU = totalAddress.byte.UB;
-
-                					_asm
-                					tblrd
-       								tblwtpostinc
-    								_endasm
-    								TABLAT = recordData[i];
-    								_asm
-    								tblwt					//Do not increment TBLPTR on the second write.  See datasheet.
-    								_endasm					
-    								
-    								EECON1 = 0b00100100;	//Word programming mode
-    								INTCONbits.GIE = 0;		//Make certain interrupts disabled for unlock process.
-    								_asm
-    								MOVLW 0x55
-    								MOVWF EECON2, 0
-    								MOVLW 0xAA
-    								MOVWF EECON2, 0
-    								BSF EECON1, 1, 0		//Initiates write operation (halts CPU execution until complete)
-    								_endasm		
-    
-    							    //Good practice now to clear the WREN bit, as further protection against any
-    								//	 future accidental activation of self write/erase operations.
-    								EECON1bits.WREN = 0;
-    
-    								totalAddress.Val = totalAddress.Val + 2;
+            //unable to read data from the file, or it ended early
+            BLIO_ReportBootStatus(BL_FS_FILE_ERR, "BL: Media Error - Unable to read file\r\n" );
+            FSfclose( fp );
+            return FALSE;
+        }
 
-                                    oddPacketDetected = FALSE;
-                                }
+        if(result != LOADER_EOF)
+        {
+            FSfclose( fp );
+            return FALSE;
+        }
 
-                                else
-                                {
-    								TBLPTRL = totalAddress.byte.LB;
-    								TBLPTRH = totalAddress.byte.HB;
-    								TBLPTRU = totalAddress.byte.UB;
-    
-    								TABLAT = recordData[i];
-    								_asm
-    								tblwtpostinc
-    								_endasm
-    								i++;
-    								TABLAT = recordData[i];
-    								_asm
-    								tblwt					//Do not increment TBLPTR on the second write.  See datasheet.
-    								_endasm					
-    								
-    								EECON1 = 0b00100100;	//Word programming mode
-    								INTCONbits.GIE = 0;		//Make certain interrupts disabled for unlock process.
-    								_asm
-    								MOVLW 0x55
-    								MOVWF EECON2, 0
-    								MOVLW 0xAA
-    								MOVWF EECON2, 0
-    								BSF EECON1, 1, 0		//Initiates write operation (halts CPU execution until complete)
-    								_endasm		
-    
-    							    //Good practice now to clear the WREN bit, as further protection against any
-    								//	 future accidental activation of self write/erase operations.
-    								EECON1bits.WREN = 0;
-    
-    								totalAddress.Val = totalAddress.Val + 2;
-                                }
-							}
-
-                            if(oddPacketDetected)
-                            {
-                                if(byteCount.Val == 1)
-                                {
-                                    totalAddress.Val--;
-
-    								TBLPTRL = totalAddress.byte.LB;
-    								TBLPTRH = totalAddress.byte.HB;
-    								TBLPTRU = totalAddress.byte.UB;
-
-                					_asm
-                					tblrd
-                                    _endasm
-
-                                    _asm
-       								tblwtpostinc
-    								_endasm
-    								TABLAT = recordData[i];
-    								_asm
-    								tblwt					//Do not increment TBLPTR on the second write.  See datasheet.
-    								_endasm					
-    								
-    								EECON1 = 0b00100100;	//Word programming mode
-    								INTCONbits.GIE = 0;		//Make certain interrupts disabled for unlock process.
-    								_asm
-    								MOVLW 0x55
-    								MOVWF EECON2, 0
-    								MOVLW 0xAA
-    								MOVWF EECON2, 0
-    								BSF EECON1, 1, 0		//Initiates write operation (halts CPU execution until complete)
-    								_endasm		
-    
-    							    //Good practice now to clear the WREN bit, as further protection against any
-    								//	 future accidental activation of self write/erase operations.
-    								EECON1bits.WREN = 0;
-    
-    								totalAddress.Val = totalAddress.Val + 1;
-
-                                    oddPacketDetected = FALSE;
-                                }
-                                else
-                                {
-    								TBLPTRL = totalAddress.byte.LB;
-    								TBLPTRH = totalAddress.byte.HB;
-    								TBLPTRU = totalAddress.byte.UB;
-    
-    								TABLAT = recordData[i];
-    								_asm
-    								tblwtpostinc
-    								_endasm
-    								TABLAT = 0xFF;
-    								_asm
-    								tblwt					//Do not increment TBLPTR on the second write.  See datasheet.
-    								_endasm
-    
-    								EECON1 = 0b00100100;	//Word programming mode
-    								INTCONbits.GIE = 0;		//Make certain interrupts disabled for unlock process.
-    								_asm
-    								MOVLW 0x55
-    								MOVWF EECON2, 0
-    								MOVLW 0xAA
-    								MOVWF EECON2, 0
-    								BSF EECON1, 1, 0		//Initiates write operation (halts CPU execution until complete)
-    								_endasm	
-    
-                                    oddPacketDetected = FALSE;
-                                }
-                            }
-
-
-                            break;
-                        case RECORD_TYPE_EOF:
-                            FSfclose( fp );
-                            return TRUE;
-                            break;
-                        case RECORD_TYPE_EXTENDED_ADDRESS:
-                            extendedAddress.v[1] = recordData[0];
-                            extendedAddress.v[0] = recordData[1];
-                            break;
-                    }
-                    break;
-                default:
-                    FSfclose( fp );
-                    return FALSE;
-            }
-
-            if(nBuffer != 9)
-            {
-                nBuffer++;
-            }
-
-            if(nBuffer == 12)
-            {
-                nBuffer = 0;
-            }
-
-            nRemaining--;
+        if(sink != Loader_RowWrite)
+        {
+            // Whole image compared; read it again and program it
+            sink = Loader_RowWrite;
+            continue;
         }
 
+        Loader_RowFlush();
+        Loader_ClearData();
         FSfclose( fp );
+        return TRUE;
     }
-    return TRUE;
 
 } // BLMedia_LoadFile
 
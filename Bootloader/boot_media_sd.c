@@ -0,0 +1,1258 @@
+/*
+*******************************************************************************
+SD Card Image Reader
+
+FSfread looks up the cluster and sends a single block read (CMD17) for
+every sector, and only returns once the card has found and sent it, so
+the command overhead and the card's access time (often a millisecond or
+more) are added to every sector of the image.  This reader follows the
+file's cluster chain itself and streams each run of contiguous clusters
+with one multiple block read (CMD18), stopping the card (CMD12) where the
+run ends.  The sectors are passed to a callback, normally the loader's
+decoder, straight from the buffer they are received into.
+
+BLSd_MapFile follows the whole cluster chain once, when the file is
+opened, and keeps the runs as a list of sector ranges (extents).  Reading
+then only needs the card, with no FAT lookups (each a sector read on a
+large FAT32 card) between runs, and the map serves both passes over the
+image.  A broken chain is found before anything is programmed.  A file in
+more than BL_SD_MAX_EXTENTS pieces is mapped up to there, and the rest of
+its chain is followed as it is read.
+
+While the callback decodes and programs a sector, the card fetches the
+next one into its own buffer, and it is clocked in when the callback
+returns.  At the end of a run the next run is started before the last
+sector is handed over, so the card reads ahead across runs too.
+
+The MSSP needs the CPU for every byte it moves and the CPU stalls while
+Flash is written, so the transfer itself cannot overlap programming; only
+the card's access time can.  The card's buffer also stands in for a second
+sector buffer, which there is no room for in RAM.
+
+Timer0 measures the load and the time spent waiting for the card, to show
+how much of the access time is left uncovered.
+
+The file system runs the SPI clock at a rate every card can take.  After
+the card is initialized, BLSd_TuneClock raises the clock a step at a time
+(Fosc/64, /16, /8 and /4, that is 750 kHz to 12 MHz) and reads the first
+sector of the card a few times at each step, checking the data CRC and
+that the data is the same as at the lowest clock.  It keeps the fastest
+step that passes.  The bus is shared with the accelerometer and runs off
+the board, so the fastest step is not always reliable.  Above the lowest
+step, loads check the data CRC of every sector as well, working it out
+for each byte while the next one is clocked in, since a BLF image's own
+CRC is only checked after its data has been programmed.  If a read fails
+or a CRC is wrong during a load, the reader drops one step and reads the
+sector again.  At the lowest step, the file system's own rate, the CRC is
+not checked.
+*******************************************************************************
+*/
+
+#include "GenericTypedefs.h"
+#include "HardwareProfile.h"
+#include "boot.h"
+#include "Compiler.h"
+#include "MDD File System\FSIO.h"
+#include "boot_media_sd.h"
+
+#if BL_READ_BUFFER_SIZE != MEDIA_SECTOR_SIZE
+    #error "BL_READ_BUFFER_SIZE must be MEDIA_SECTOR_SIZE"
+#endif
+
+#ifndef BL_SD_MAX_EXTENTS
+    #define BL_SD_MAX_EXTENTS       8
+#endif
+
+// SD card commands and tokens (SPI mode)
+#define SD_CMD_STOP_TRANSMISSION    12
+#define SD_CMD_READ_SINGLE_BLOCK    17
+#define SD_CMD_READ_MULTIPLE_BLOCK  18
+#define SD_CMD_READ_OCR             58
+#define SD_CMD_START                0x40    // Start and transmission bits
+#define SD_CMD_CRC                  0x01    // CRC is not checked, stop bit
+#define SD_R1_READY                 0x00
+#define SD_R1_INVALID               0x80    // No response yet
+#define SD_RESPONSE_BYTES           8       // Bytes to wait for a response
+#define SD_DATA_START_TOKEN         0xFE
+#define SD_OCR_CCS                  0x40    // Card capacity status (first byte)
+
+// SPI master clock modes (SSPM bits of SSPxCON1)
+#define SD_SPI_MODE_MASK            0x0F
+#define SD_SPI_FOSC_4               0b0000
+#define SD_SPI_FOSC_8               0b1010
+#define SD_SPI_FOSC_16              0b0001
+#define SD_SPI_FOSC_64              0b0010
+
+// Clock tuning: sector read at each step, and number of reads
+#define SD_TUNE_SECTOR              0
+#define SD_TUNE_READS               4
+
+// Timer0: Fosc/4 (48 MHz clock), 1:256 prescaler, 16 bit
+#define SD_TIMER_CONFIG             0b10000111
+#define SD_TIMER_TICKS_PER_SECOND   (48000000UL / 4 / 256)
+#define TicksToMs(t)                ((t) * 8 / (SD_TIMER_TICKS_PER_SECOND / 125))
+
+// Longest wait for the start of a sector (the card's read timeout is 100ms)
+#define SD_READ_TIMEOUT             ((WORD)(SD_TIMER_TICKS_PER_SECOND / 4))
+
+// FSIO.c routine, not declared in FSIO.h: next cluster of a chain
+DWORD ReadFAT ( DISK *dsk, DWORD ccls );
+
+// Contiguous piece of a file
+typedef struct
+{
+    DWORD   sector;                 // First sector on the card
+    DWORD   sectors;                // Number of sectors
+
+} SD_EXTENT;
+
+
+//******************************************************************************
+//******************************************************************************
+// Global Data
+//******************************************************************************
+//******************************************************************************
+
+// Volume and size of the mapped file
+DISK           *sdDisk;
+DWORD           sdFileSize;
+
+// Map of the file, and the first cluster and the number of sectors of the
+// part of the file that did not fit in the map
+SD_EXTENT       sdExtent[BL_SD_MAX_EXTENTS];
+BYTE            sdExtents = 0;
+DWORD           sdMapCluster;
+DWORD           sdMapLeft;
+
+// Next extent to read, then the first cluster of the next run and the
+// number of file sectors after the run being read (past the map)
+BYTE            sdExtentIndex;
+DWORD           sdCluster;
+DWORD           sdSectorsLeft;
+
+// File bytes not yet returned
+DWORD           sdUnreturned;
+
+// Sector the card sends next, and the number of sectors left in the run
+// it is streaming (0 when it is not)
+DWORD           sdNextSector;
+DWORD           sdRunLeft = 0;
+
+// TRUE if the card takes sector numbers (SDHC), FALSE for byte addresses
+BOOL            sdBlockAddressing;
+
+// SPI clock step in use, index into sdClockModes
+BYTE            sdClockStep = 0;
+
+// Load time and card wait time in Timer0 ticks, and the last timer value
+DWORD           sdLoadTicks;
+DWORD           sdWaitTicks;
+WORD            sdLastTick;
+
+// SPI clock steps, slowest first
+rom BYTE sdClockModes[] = { SD_SPI_FOSC_64, SD_SPI_FOSC_16, SD_SPI_FOSC_8, SD_SPI_FOSC_4 };
+#define SD_CLOCK_STEPS              (sizeof(sdClockModes) / sizeof(sdClockModes[0]))
+
+// CRC-16 (polynomial 0x1021) of each nibble value, for the data CRC
+rom WORD sdCrcTable[16] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+
+//******************************************************************************
+//******************************************************************************
+// Local Routines
+//******************************************************************************
+//******************************************************************************
+
+/****************************************************************************
+  Function:
+    WORD TimerRead ( void )
+
+  Description:
+    Reads Timer0.
+
+  Precondition:
+    BLSd_StartTiming has been called.
+
+  Parameters:
+    None
+
+  Returns:
+    Timer0 value
+
+  Remarks:
+    TMR0L must be read first; it latches TMR0H.
+***************************************************************************/
+
+static WORD TimerRead ( void )
+{
+    WORD_VAL    ticks;
+
+    ticks.v[0] = TMR0L;
+    ticks.v[1] = TMR0H;
+    return ticks.Val;
+
+} // TimerRead
+
+
+/****************************************************************************
+  Function:
+    void TimerUpdate ( void )
+
+  Description:
+    Adds the time since the last update to the load time.
+
+  Precondition:
+    BLSd_StartTiming has been called.
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    Must be called at least once per timer period (1.4s).
+***************************************************************************/
+
+static void TimerUpdate ( void )
+{
+    WORD    now;
+
+    now          = TimerRead();
+    sdLoadTicks += (WORD)(now - sdLastTick);
+    sdLastTick   = now;
+
+} // TimerUpdate
+
+
+/****************************************************************************
+  Function:
+    BYTE SpiExchange ( BYTE data )
+
+  Description:
+    Sends a byte to the card and returns the byte received with it.
+
+  Precondition:
+    The file system has initialized the SPI module and the card.
+
+  Parameters:
+    data        - Byte to send
+
+  Returns:
+    Byte received
+
+  Remarks:
+    None
+***************************************************************************/
+
+static BYTE SpiExchange ( BYTE data )
+{
+    SPIBUF = data;
+    while (!SPISTAT_RBF)
+    {
+    }
+    return SPIBUF;
+
+} // SpiExchange
+
+
+/****************************************************************************
+  Function:
+    BYTE SendCommand ( BYTE command, DWORD argument )
+
+  Description:
+    Sends a command to the card and waits for its R1 response.
+
+  Precondition:
+    The card is selected.
+
+  Parameters:
+    command     - Command index
+    argument    - Command argument
+
+  Returns:
+    R1 response, SD_R1_READY if the card accepted the command
+
+  Remarks:
+    None
+***************************************************************************/
+
+static BYTE SendCommand ( BYTE command, DWORD argument )
+{
+    DWORD_VAL   value;
+    BYTE        response;
+    BYTE        count;
+
+    value.Val = argument;
+
+    SpiExchange(0xFF);
+    SpiExchange(SD_CMD_START | command);
+    SpiExchange(value.v[3]);
+    SpiExchange(value.v[2]);
+    SpiExchange(value.v[1]);
+    SpiExchange(value.v[0]);
+    SpiExchange(SD_CMD_CRC);
+
+    // CMD12 is followed by a stuff byte (the card may still be sending)
+    if (command == SD_CMD_STOP_TRANSMISSION)
+    {
+        SpiExchange(0xFF);
+    }
+
+    count = SD_RESPONSE_BYTES;
+    do
+    {
+        response = SpiExchange(0xFF);
+    } while ((response & SD_R1_INVALID) && --count > 0);
+
+    return response;
+
+} // SendCommand
+
+
+/****************************************************************************
+  Function:
+    void Deselect ( void )
+
+  Description:
+    Deselects the card and gives it the clocks it needs to release the bus.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    None
+***************************************************************************/
+
+static void Deselect ( void )
+{
+    SD_CS = 1;
+    SpiExchange(0xFF);
+
+} // Deselect
+
+
+/****************************************************************************
+  Function:
+    void SetClock ( BYTE step )
+
+  Description:
+    Sets the SPI clock.
+
+  Precondition:
+    The card is not selected.
+
+  Parameters:
+    step        - Clock step, index into sdClockModes
+
+  Returns:
+    None
+
+  Remarks:
+    The MSSP must be disabled while its mode changes.
+***************************************************************************/
+
+static void SetClock ( BYTE step )
+{
+    sdClockStep = step;
+    SPIENABLE   = 0;
+    SPICON1     = (SPICON1 & ~SD_SPI_MODE_MASK) | sdClockModes[step];
+    SPIENABLE   = 1;
+
+} // SetClock
+
+
+/****************************************************************************
+  Function:
+    BOOL ClockDown ( void )
+
+  Description:
+    Lowers the SPI clock one step after a read or CRC error.
+
+  Precondition:
+    The card is not selected.
+
+  Parameters:
+    None
+
+  Returns:
+    TRUE        - The clock is one step lower
+    FALSE       - The clock already is at the lowest step
+
+  Remarks:
+    None
+***************************************************************************/
+
+static BOOL ClockDown ( void )
+{
+    if (sdClockStep == 0)
+    {
+        return FALSE;
+    }
+    SetClock(sdClockStep - 1);
+    return TRUE;
+
+} // ClockDown
+
+
+/****************************************************************************
+  Function:
+    void ReadAddressing ( void )
+
+  Description:
+    Reads the card's OCR to find out how it is addressed.
+
+  Precondition:
+    The file system has initialized the card.
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    High capacity cards are addressed by sector, others by byte.
+***************************************************************************/
+
+static void ReadAddressing ( void )
+{
+    BYTE    response;
+    BYTE    ocr;
+
+    // Clear anything the file system left in the receive buffer
+    response = SPIBUF;
+
+    SD_CS    = 0;
+    response = SendCommand(SD_CMD_READ_OCR, 0);
+    ocr      = SpiExchange(0xFF);
+    SpiExchange(0xFF);
+    SpiExchange(0xFF);
+    SpiExchange(0xFF);
+    Deselect();
+
+    sdBlockAddressing = (response == SD_R1_READY) && (ocr & SD_OCR_CCS);
+
+} // ReadAddressing
+
+
+/****************************************************************************
+  Function:
+    DWORD ClusterSector ( DWORD cluster )
+
+  Description:
+    Gives the first sector of a cluster.
+
+  Precondition:
+    sdDisk is set.
+
+  Parameters:
+    cluster     - Cluster number, 2 or above
+
+  Returns:
+    Sector number on the card
+
+  Remarks:
+    None
+***************************************************************************/
+
+static DWORD ClusterSector ( DWORD cluster )
+{
+    return sdDisk->data + (cluster - 2) * sdDisk->SecPerClus;
+
+} // ClusterSector
+
+
+/****************************************************************************
+  Function:
+    BOOL WaitReady ( void )
+
+  Description:
+    Waits while the card signals busy (holds its output low).
+
+  Precondition:
+    The card is selected.
+
+  Parameters:
+    None
+
+  Returns:
+    TRUE        - The card is ready
+    FALSE       - The card was still busy after SD_READ_TIMEOUT
+
+  Remarks:
+    None
+***************************************************************************/
+
+static BOOL WaitReady ( void )
+{
+    WORD    start;
+
+    start = TimerRead();
+    while (SpiExchange(0xFF) != 0xFF)
+    {
+        if ((WORD)(TimerRead() - start) >= SD_READ_TIMEOUT)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+
+} // WaitReady
+
+
+/****************************************************************************
+  Function:
+    BOOL StartStream ( DWORD sector )
+
+  Description:
+    Asks the card to read sectors from the given one on (CMD18).  The card
+    is left selected and sends one sector after the other, as fast as they
+    are clocked in, until StopStream.
+
+  Precondition:
+    The card is not selected.
+
+  Parameters:
+    sector      - Sector number on the card of the first sector
+
+  Returns:
+    TRUE        - The card is reading
+    FALSE       - The card did not accept the command
+
+  Remarks:
+    None
+***************************************************************************/
+
+static BOOL StartStream ( DWORD sector )
+{
+    SD_CS = 0;
+    if (SendCommand(SD_CMD_READ_MULTIPLE_BLOCK, sdBlockAddressing ? sector : sector << 9) != SD_R1_READY)
+    {
+        Deselect();
+        return FALSE;
+    }
+
+    sdNextSector = sector;
+    return TRUE;
+
+} // StartStream
+
+
+/****************************************************************************
+  Function:
+    void StopStream ( void )
+
+  Description:
+    Stops the card reading sectors (CMD12) and deselects it.
+
+  Precondition:
+    StartStream has returned TRUE.
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    The card may be in the middle of a sector; the rest of it is dropped.
+***************************************************************************/
+
+static void StopStream ( void )
+{
+    SendCommand(SD_CMD_STOP_TRANSMISSION, 0);
+    WaitReady();
+    Deselect();
+
+} // StopStream
+
+
+/****************************************************************************
+  Function:
+    BOOL WaitDataStart ( void )
+
+  Description:
+    Waits for the card to start sending the data of a sector, and adds the
+    time to the card wait time.
+
+  Precondition:
+    The card is reading.
+
+  Parameters:
+    None
+
+  Returns:
+    TRUE        - The data follows
+    FALSE       - Error token, or the card did not answer in time
+
+  Remarks:
+    None
+***************************************************************************/
+
+static BOOL WaitDataStart ( void )
+{
+    WORD    start;
+    WORD    now;
+    BYTE    token;
+
+    start = TimerRead();
+    do
+    {
+        token = SpiExchange(0xFF);
+        now   = TimerRead();
+    } while (token == 0xFF && (WORD)(now - start) < SD_READ_TIMEOUT);
+
+    sdWaitTicks += (WORD)(now - start);
+    return token == SD_DATA_START_TOKEN;
+
+} // WaitDataStart
+
+
+/****************************************************************************
+  Function:
+    BOOL ReceiveSector ( BYTE *pBuffer )
+
+  Description:
+    Receives the next sector the card sends.
+
+  Precondition:
+    StartStream has returned TRUE.
+
+  Parameters:
+    pBuffer     - Buffer for MEDIA_SECTOR_SIZE bytes
+
+  Returns:
+    TRUE        - The sector has been received
+    FALSE       - The card did not send it, or its CRC is wrong
+
+  Remarks:
+    The card stays selected and goes on to read the following sector.
+    The CRC is only checked above the lowest clock step.
+***************************************************************************/
+
+static BOOL ReceiveSector ( BYTE *pBuffer )
+{
+    WORD_VAL    received;
+    WORD        crc = 0;
+    WORD        count;
+    BYTE        data;
+
+    if (!WaitDataStart())
+    {
+        return FALSE;
+    }
+
+    if (sdClockStep == 0)
+    {
+        for (count = MEDIA_SECTOR_SIZE; count > 0; count--)
+        {
+            SPIBUF = 0xFF;
+            while (!SPISTAT_RBF)
+            {
+            }
+            *pBuffer++ = SPIBUF;
+        }
+
+        // CRC, not checked
+        SpiExchange(0xFF);
+        SpiExchange(0xFF);
+
+        return TRUE;
+    }
+
+    // Each byte's CRC is worked out while the next byte (after the last
+    // data byte, the first CRC byte) is clocked in
+    SPIBUF = 0xFF;
+    for (count = MEDIA_SECTOR_SIZE; count > 0; count--)
+    {
+        while (!SPISTAT_RBF)
+        {
+        }
+        data       = SPIBUF;
+        SPIBUF     = 0xFF;
+        *pBuffer++ = data;
+        crc = (crc << 4) ^ sdCrcTable[(BYTE)(crc >> 12) ^ (data >> 4)];
+        crc = (crc << 4) ^ sdCrcTable[(BYTE)(crc >> 12) ^ (data & 0x0F)];
+    }
+    while (!SPISTAT_RBF)
+    {
+    }
+    received.v[1] = SPIBUF;
+    received.v[0] = SpiExchange(0xFF);
+
+    return crc == received.Val;
+
+} // ReceiveSector
+
+
+/****************************************************************************
+  Function:
+    BOOL ReadCheck ( DWORD sector, WORD *pCrc )
+
+  Description:
+    Reads a sector (CMD17) without keeping the data, and checks its CRC.
+
+  Precondition:
+    The card is not selected.
+
+  Parameters:
+    sector      - Sector number on the card
+    pCrc        - Where to store the CRC of the data
+
+  Returns:
+    TRUE        - The sector was read and its CRC is correct
+    FALSE       - Read error or wrong CRC
+
+  Remarks:
+    None
+***************************************************************************/
+
+static BOOL ReadCheck ( DWORD sector, WORD *pCrc )
+{
+    WORD_VAL    received;
+    WORD        crc = 0;
+    WORD        count;
+    BYTE        data;
+
+    SD_CS = 0;
+    if (SendCommand(SD_CMD_READ_SINGLE_BLOCK, sdBlockAddressing ? sector : sector << 9) != SD_R1_READY ||
+        !WaitDataStart())
+    {
+        Deselect();
+        return FALSE;
+    }
+
+    for (count = MEDIA_SECTOR_SIZE; count > 0; count--)
+    {
+        data = SpiExchange(0xFF);
+        crc  = (crc << 4) ^ sdCrcTable[(BYTE)(crc >> 12) ^ (data >> 4)];
+        crc  = (crc << 4) ^ sdCrcTable[(BYTE)(crc >> 12) ^ (data & 0x0F)];
+    }
+    received.v[1] = SpiExchange(0xFF);
+    received.v[0] = SpiExchange(0xFF);
+
+    Deselect();
+
+    *pCrc = crc;
+    return crc == received.Val;
+
+} // ReadCheck
+
+
+/****************************************************************************
+  Function:
+    BOOL StartRun ( void )
+
+  Description:
+    Has the card stream the next run of the file: the next extent of the
+    map, or past the map, the clusters from sdCluster on as far as they
+    are contiguous.
+
+  Precondition:
+    OpenFile has set up the file, sectors of it are left, and the card is
+    not selected.
+
+  Parameters:
+    None
+
+  Returns:
+    TRUE        - The card is streaming the run
+    FALSE       - Broken cluster chain, or the card did not accept the
+                  command even at the lowest clock
+
+  Remarks:
+    Past the map, the FAT is read before the stream starts, as the file
+    system needs the card to read it.
+***************************************************************************/
+
+static BOOL StartRun ( void )
+{
+    DWORD   first;
+    DWORD   last;
+    DWORD   next = 0;
+    DWORD   sectors;
+
+    if (sdExtentIndex < sdExtents)
+    {
+        first   = sdExtent[sdExtentIndex].sector;
+        sectors = sdExtent[sdExtentIndex].sectors;
+        sdExtentIndex++;
+    }
+    else
+    {
+        if (sdCluster < 2 || sdCluster > sdDisk->maxcls + 1)
+        {
+            return FALSE;
+        }
+
+        last    = sdCluster;
+        sectors = sdDisk->SecPerClus;
+        while (sectors < sdSectorsLeft)
+        {
+            next = ReadFAT(sdDisk, last);
+            if (next != last + 1)
+            {
+                break;
+            }
+            last     = next;
+            sectors += sdDisk->SecPerClus;
+        }
+
+        if (sectors > sdSectorsLeft)
+        {
+            sectors = sdSectorsLeft;
+        }
+
+        first          = ClusterSector(sdCluster);
+        sdCluster      = next;
+        sdSectorsLeft -= sectors;
+    }
+
+    while (!StartStream(first))
+    {
+        if (!ClockDown())
+        {
+            return FALSE;
+        }
+    }
+
+    sdRunLeft = sectors;
+    return TRUE;
+
+} // StartRun
+
+
+/****************************************************************************
+  Function:
+    BOOL OpenFile ( void )
+
+  Description:
+    Prepares to read the mapped file from its first sector and has the
+    card start streaming the first run of it.
+
+  Precondition:
+    BLSd_MapFile has returned TRUE.
+
+  Parameters:
+    None
+
+  Returns:
+    TRUE        - The card is reading the file
+    FALSE       - The file cannot be read
+
+  Remarks:
+    None
+***************************************************************************/
+
+static BOOL OpenFile ( void )
+{
+    sdExtentIndex = 0;
+    sdCluster     = sdMapCluster;
+    sdSectorsLeft = sdMapLeft;
+    sdUnreturned  = sdFileSize;
+    sdRunLeft     = 0;
+
+    if (sdExtents == 0)
+    {
+        return FALSE;
+    }
+
+    // The file system may have set up the card again since it was tuned
+    SetClock(sdClockStep);
+    ReadAddressing();
+
+    return StartRun();
+
+} // OpenFile
+
+
+/****************************************************************************
+  Function:
+    WORD ReadSector ( BYTE *pBuffer )
+
+  Description:
+    Receives the next sector of the file.  At the end of a run it stops
+    the card and starts the next run, so the card reads ahead while the
+    caller works on this sector.
+
+  Precondition:
+    OpenFile has returned TRUE.
+
+  Parameters:
+    pBuffer     - Buffer of MEDIA_SECTOR_SIZE bytes for the data
+
+  Returns:
+    Number of file bytes in the buffer, MEDIA_SECTOR_SIZE except for the
+    last sector of the file.  0 after the end of the file or on an error.
+
+  Remarks:
+    If the sector cannot be received, or its CRC is wrong, the run is
+    started again from it at a lower clock.  If the next run cannot be started, this sector is
+    still returned and the next call returns 0.
+***************************************************************************/
+
+static WORD ReadSector ( BYTE *pBuffer )
+{
+    WORD    length;
+
+    TimerUpdate();
+
+    if (sdRunLeft == 0)
+    {
+        return 0;
+    }
+
+    while (!ReceiveSector(pBuffer))
+    {
+        // Read error: stream again from this sector at a lower clock
+        StopStream();
+        if (!ClockDown() || !StartStream(sdNextSector))
+        {
+            sdRunLeft = 0;
+            return 0;
+        }
+    }
+
+    sdNextSector++;
+    if (--sdRunLeft == 0)
+    {
+        StopStream();
+        if (sdExtentIndex < sdExtents || sdSectorsLeft > 0)
+        {
+            StartRun();
+        }
+    }
+
+    length = (sdUnreturned > MEDIA_SECTOR_SIZE) ? MEDIA_SECTOR_SIZE : (WORD)sdUnreturned;
+    sdUnreturned -= length;
+    return length;
+
+} // ReadSector
+
+
+/****************************************************************************
+  Function:
+    void CloseFile ( void )
+
+  Description:
+    Ends reading the file, and stops the card if it is still streaming.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    None
+***************************************************************************/
+
+static void CloseFile ( void )
+{
+    if (sdRunLeft > 0)
+    {
+        StopStream();
+        sdRunLeft = 0;
+    }
+
+    TimerUpdate();
+
+} // CloseFile
+
+
+//******************************************************************************
+//******************************************************************************
+// SD Card Image Reader Interface
+//******************************************************************************
+//******************************************************************************
+
+/****************************************************************************
+  Function:
+    void BLSd_StartTiming ( void )
+
+  Description:
+    Starts the load timer and clears the load and card wait times.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    Uses Timer0.
+***************************************************************************/
+
+void BLSd_StartTiming ( void )
+{
+    T0CON       = SD_TIMER_CONFIG;
+    sdLoadTicks = 0;
+    sdWaitTicks = 0;
+    sdLastTick  = TimerRead();
+
+} // BLSd_StartTiming
+
+
+/****************************************************************************
+  Function:
+    BOOL BLSd_TuneClock ( void )
+
+  Description:
+    Raises the SPI clock a step at a time, as long as the card reads
+    reliably, and keeps the fastest step that works.
+
+  Precondition:
+    The file system has initialized the card.
+
+  Parameters:
+    None
+
+  Returns:
+    TRUE        - The card can be read, at the clock now set
+    FALSE       - The card cannot be read even at the lowest clock
+
+  Remarks:
+    Restarts the load timer.
+***************************************************************************/
+
+BOOL BLSd_TuneClock ( void )
+{
+    WORD    reference;
+    WORD    crc;
+    BYTE    step;
+    BYTE    count;
+
+    BLSd_StartTiming();
+    SetClock(0);
+    ReadAddressing();
+
+    if (!ReadCheck(SD_TUNE_SECTOR, &reference))
+    {
+        return FALSE;
+    }
+
+    for (step = 1; step < SD_CLOCK_STEPS; step++)
+    {
+        SetClock(step);
+        for (count = SD_TUNE_READS; count > 0; count--)
+        {
+            if (!ReadCheck(SD_TUNE_SECTOR, &crc) || crc != reference)
+            {
+                break;
+            }
+        }
+        if (count != 0)
+        {
+            // Too fast; keep the step below
+            SetClock(step - 1);
+            break;
+        }
+    }
+
+    return TRUE;
+
+} // BLSd_TuneClock
+
+
+/****************************************************************************
+  Function:
+    BOOL BLSd_MapFile ( FSFILE *fp )
+
+  Description:
+    Follows the cluster chain of a file and records where its contiguous
+    pieces are on the card.
+
+  Precondition:
+    The file has been opened with FSfopen.
+
+  Parameters:
+    fp          - The open file
+
+  Returns:
+    TRUE        - The file is mapped
+    FALSE       - The file is empty, or its cluster chain is broken
+
+  Remarks:
+    Only the first BL_SD_MAX_EXTENTS pieces are mapped; the chain past
+    them is followed while the file is read.
+***************************************************************************/
+
+BOOL BLSd_MapFile ( FSFILE *fp )
+{
+    SD_EXTENT  *pExtent = NULL;
+    DWORD       cluster;
+    DWORD       sector;
+    DWORD       left;
+    BYTE        count;
+
+    sdDisk     = fp->dsk;
+    sdFileSize = fp->size;
+    sdExtents  = 0;
+
+    cluster = fp->cluster;
+    left    = (fp->size + MEDIA_SECTOR_SIZE - 1) / MEDIA_SECTOR_SIZE;
+    while (left > 0)
+    {
+        if (cluster < 2 || cluster > sdDisk->maxcls + 1)
+        {
+            sdExtents = 0;
+            return FALSE;
+        }
+
+        sector = ClusterSector(cluster);
+        if (pExtent == NULL || pExtent->sector + pExtent->sectors != sector)
+        {
+            if (sdExtents == BL_SD_MAX_EXTENTS)
+            {
+                break;
+            }
+            pExtent          = &sdExtent[sdExtents++];
+            pExtent->sector  = sector;
+            pExtent->sectors = 0;
+        }
+
+        count             = (left > sdDisk->SecPerClus) ? sdDisk->SecPerClus : (BYTE)left;
+        pExtent->sectors += count;
+        left             -= count;
+
+        if (left > 0)
+        {
+            cluster = ReadFAT(sdDisk, cluster);
+        }
+    }
+
+    sdMapCluster = cluster;
+    sdMapLeft    = left;
+    return sdExtents > 0;
+
+} // BLSd_MapFile
+
+
+/****************************************************************************
+  Function:
+    BYTE BLSd_StreamFile ( BYTE *pBuffer, SD_SECTOR_SINK sink )
+
+  Description:
+    Reads the mapped file from its first sector and passes each sector to
+    a callback until the callback is done with the file.
+
+  Precondition:
+    BLSd_MapFile has returned TRUE.  BLSd_StartTiming has been called.
+
+  Parameters:
+    pBuffer     - Buffer of MEDIA_SECTOR_SIZE bytes the sectors are read
+                  into
+    sink        - Callback that takes each sector, with the number of file
+                  bytes in it.  It returns LOADER_NEED_DATA for more.
+
+  Returns:
+    The last result of the callback, other than LOADER_NEED_DATA.
+    LOADER_NEED_DATA if the file ended or could not be read first.
+
+  Remarks:
+    Can be called again to read the file again.  The card is stopped and
+    deselected on return, so the file system can use it.
+***************************************************************************/
+
+BYTE BLSd_StreamFile ( BYTE *pBuffer, SD_SECTOR_SINK sink )
+{
+    BYTE    result = LOADER_NEED_DATA;
+    WORD    length;
+
+    if (OpenFile())
+    {
+        while (result == LOADER_NEED_DATA && (length = ReadSector(pBuffer)) != 0)
+        {
+            result = sink(pBuffer, length);
+        }
+    }
+    CloseFile();
+
+    return result;
+
+} // BLSd_StreamFile
+
+
+/****************************************************************************
+  Function:
+    WORD BLSd_LoadTime ( void )
+
+  Description:
+    Time from BLSd_StartTiming to the last read or close, in milliseconds.
+
+  Precondition:
+    BLSd_StartTiming has been called.
+
+  Parameters:
+    None
+
+  Returns:
+    Time in milliseconds, at most 65535
+
+  Remarks:
+    None
+***************************************************************************/
+
+WORD BLSd_LoadTime ( void )
+{
+    DWORD   ms;
+
+    ms = TicksToMs(sdLoadTicks);
+    return (ms > 0xFFFF) ? 0xFFFF : (WORD)ms;
+
+} // BLSd_LoadTime
+
+
+/****************************************************************************
+  Function:
+    WORD BLSd_WaitTime ( void )
+
+  Description:
+    Part of the load time spent waiting for the card to start sending a
+    sector, that decoding and programming did not cover.
+
+  Precondition:
+    BLSd_StartTiming has been called.
+
+  Parameters:
+    None
+
+  Returns:
+    Time in milliseconds, at most 65535
+
+  Remarks:
+    None
+***************************************************************************/
+
+WORD BLSd_WaitTime ( void )
+{
+    DWORD   ms;
+
+    ms = TicksToMs(sdWaitTicks);
+    return (ms > 0xFFFF) ? 0xFFFF : (WORD)ms;
+
+} // BLSd_WaitTime
+
+
+/*
+*******************************************************************************
+EOF
+*******************************************************************************
+*/
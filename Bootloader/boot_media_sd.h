@@ -0,0 +1,175 @@
+/*
+*******************************************************************************
+SD Card Image Reader
+
+Maps an open image file and reads it straight from the SD card, one sector
+at a time, for the MSD media layer.  Implemented in boot_media_sd.c.
+Include "MDD File System\FSIO.h" before this file.
+*******************************************************************************
+*/
+
+#ifndef BOOT_MEDIA_SD_H
+#define BOOT_MEDIA_SD_H
+
+// Takes a sector of the file and the number of file bytes in it, and
+// returns LOADER_NEED_DATA as long as it wants more.  Loader_HexDecode and
+// Loader_BlfDecode are sector sinks.
+typedef BYTE (*SD_SECTOR_SINK)( BYTE *pData, WORD length );
+
+
+/****************************************************************************
+  Function:
+    void BLSd_StartTiming ( void )
+
+  Description:
+    Starts the load timer and clears the load and card wait times.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    Uses Timer0.
+***************************************************************************/
+
+void BLSd_StartTiming ( void );
+
+
+/****************************************************************************
+  Function:
+    BOOL BLSd_TuneClock ( void )
+
+  Description:
+    Raises the SPI clock a step at a time, as long as the card reads
+    reliably, and keeps the fastest step that works.
+
+  Precondition:
+    The file system has initialized the card.
+
+  Parameters:
+    None
+
+  Returns:
+    TRUE        - The card can be read, at the clock now set
+    FALSE       - The card cannot be read even at the lowest clock
+
+  Remarks:
+    Restarts the load timer.
+***************************************************************************/
+
+BOOL BLSd_TuneClock ( void );
+
+
+/****************************************************************************
+  Function:
+    BOOL BLSd_MapFile ( FSFILE *fp )
+
+  Description:
+    Follows the cluster chain of a file and records where its contiguous
+    pieces are on the card.
+
+  Precondition:
+    The file has been opened with FSfopen.
+
+  Parameters:
+    fp          - The open file
+
+  Returns:
+    TRUE        - The file is mapped
+    FALSE       - The file is empty, or its cluster chain is broken
+
+  Remarks:
+    Only the first BL_SD_MAX_EXTENTS pieces are mapped; the chain past
+    them is followed while the file is read.
+***************************************************************************/
+
+BOOL BLSd_MapFile ( FSFILE *fp );
+
+
+/****************************************************************************
+  Function:
+    BYTE BLSd_StreamFile ( BYTE *pBuffer, SD_SECTOR_SINK sink )
+
+  Description:
+    Reads the mapped file from its first sector and passes each sector to
+    a callback until the callback is done with the file.
+
+  Precondition:
+    BLSd_MapFile has returned TRUE.  BLSd_StartTiming has been called.
+
+  Parameters:
+    pBuffer     - Buffer of MEDIA_SECTOR_SIZE bytes the sectors are read
+                  into
+    sink        - Callback that takes each sector, with the number of file
+                  bytes in it.  It returns LOADER_NEED_DATA for more.
+
+  Returns:
+    The last result of the callback, other than LOADER_NEED_DATA.
+    LOADER_NEED_DATA if the file ended or could not be read first.
+
+  Remarks:
+    Can be called again to read the file again.  The card is stopped and
+    deselected on return, so the file system can use it.
+***************************************************************************/
+
+BYTE BLSd_StreamFile ( BYTE *pBuffer, SD_SECTOR_SINK sink );
+
+
+/****************************************************************************
+  Function:
+    WORD BLSd_LoadTime ( void )
+
+  Description:
+    Time from BLSd_StartTiming to the last read or close, in milliseconds.
+
+  Precondition:
+    BLSd_StartTiming has been called.
+
+  Parameters:
+    None
+
+  Returns:
+    Time in milliseconds, at most 65535
+
+  Remarks:
+    None
+***************************************************************************/
+
+WORD BLSd_LoadTime ( void );
+
+
+/****************************************************************************
+  Function:
+    WORD BLSd_WaitTime ( void )
+
+  Description:
+    Part of the load time spent waiting for the card to start sending a
+    sector, that decoding and programming did not cover.
+
+  Precondition:
+    BLSd_StartTiming has been called.
+
+  Parameters:
+    None
+
+  Returns:
+    Time in milliseconds, at most 65535
+
+  Remarks:
+    None
+***************************************************************************/
+
+WORD BLSd_WaitTime ( void );
+
+#endif
+
+/*
+*******************************************************************************
+EOF
+*******************************************************************************
+*/
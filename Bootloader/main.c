@@ -38,6 +38,7 @@ DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
 #include "HardwareProfile.h"
 #include "boot.h"
 #include "MDD File System\FSIO.h"
+#include "boot_media_sd.h"
 
 #include "oled.h"
 
@@ -108,6 +109,88 @@ Macro used to call main application
 
 #define BootApplication()       (((int(*)(void))(APPLICATION_ADDRESS))())
 
+/******************************************************************************
+  Function:
+    void PutBlockCounts ( BYTE line )
+
+  Description:
+    Shows how many Flash blocks the last load programmed and how many it 
+    skipped because they already held the image.
+
+  Precondition:
+    An image has been loaded.
+
+  Parameters:
+    line        - OLED text line to use
+
+  Returns:
+    None
+
+  Remarks:
+    None
+******************************************************************************/
+
+static void PutBlockCounts ( BYTE line )
+{
+    static char text[] = "nn written nn skipped";
+    BYTE        count;
+
+    count = Loader_BlocksProgrammed();
+    text[0] = (count >= 10) ? '0' + count / 10 : ' ';
+    text[1] = '0' + count % 10;
+
+    count = Loader_BlocksSkipped();
+    text[11] = (count >= 10) ? '0' + count / 10 : ' ';
+    text[12] = '0' + count % 10;
+
+    oledPutString((unsigned char *)text, line, 0);
+}
+
+/******************************************************************************
+  Function:
+    void PutLoadTime ( BYTE line )
+
+  Description:
+    Shows how long the last load took and how much of that was spent
+    waiting for the SD card, in milliseconds.
+
+  Precondition:
+    An image has been loaded.
+
+  Parameters:
+    line        - OLED text line to use
+
+  Returns:
+    None
+
+  Remarks:
+    None
+******************************************************************************/
+
+static void PutLoadTime ( BYTE line )
+{
+    static char text[] = "nnnnn ms, wait nnnnn";
+    WORD        ms;
+    BYTE        i;
+
+    ms = BLSd_LoadTime();
+    for (i = 5; i > 0; i--)
+    {
+        text[i - 1] = (ms != 0 || i == 5) ? '0' + ms % 10 : ' ';
+        ms /= 10;
+    }
+
+    ms = BLSd_WaitTime();
+    for (i = 20; i > 15; i--)
+    {
+        text[i - 1] = (ms != 0 || i == 20) ? '0' + ms % 10 : ' ';
+        ms /= 10;
+    }
+
+    oledPutString((unsigned char *)text, line, 0);
+}
+
+
 #define FILE_FETCH		0
 #define SCREEN_UPDATE	1
 #define USER_INPUT		2
@@ -234,6 +317,15 @@ void LoadApplication ( void )
 										}
 									}
 								}
+								/* Binary images (BLF) are listed after the hex files, as long as there is room */
+								status = FindFirstpgm("*.BLF", ATTR_ARCHIVE | ATTR_READ_ONLY | ATTR_HIDDEN, &searchRecord);
+								while ((status == 0) && (filesCounter < sizeof(fileList) / sizeof(searchRecord.filename)))
+								{
+									strcpy((char*)&fileList[filesCounter*sizeof(searchRecord.filename)], (const char*)&searchRecord.filename);
+									filesCounter ++;
+									status = FindNext(&searchRecord);
+								}
+
 								if (filesCounter != 0)
 								{
 									/* At least one file or folder was found */
@@ -336,9 +428,11 @@ void LoadApplication ( void )
 														oledPutROMString((ROM_STRING)" file:      ", 1, 0);
 														oledPutString((unsigned char *)searchRecord.filename, 1, 40);
 														oledPutROMString((ROM_STRING)" has been loaded.    ", 2, 0);
+														PutBlockCounts(3);
 														oledPutROMString((ROM_STRING)"Press the R button to", 4, 0);
 														oledPutROMString((ROM_STRING)"start the application", 5, 0);
 														oledPutROMString((ROM_STRING)"or L button to cancel", 6, 0);
+														PutLoadTime(7);
 
 														/* Read the R button - RA0 */
 														button1 = mTouchReadButton(0);
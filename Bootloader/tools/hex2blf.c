@@ -0,0 +1,399 @@
+/*
+*******************************************************************************
+hex2blf - converts an Intel HEX file to a boot loader binary image (BLF)
+
+    hex2blf [-b base] [-e end] [-v version] image.hex image.blf
+
+Only data from base up to end (default PROGRAM_FLASH_BASE and
+PROGRAM_FLASH_END of boot_config.h) goes into the image; anything else in
+the hex file, such as the reset vector or the configuration words, is
+dropped with a warning.  The payload runs from the first to the last row
+the hex file gives data for; bytes it does not give are 0xFF, which the
+boot loader treats as gaps.  See boot_load_blf.h for the format.
+
+Numbers may be given in decimal or, with 0x, in hex.
+*******************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "../boot_load_blf.h"
+
+// Program memory range of the application, as in boot_config.h
+#define DEFAULT_BASE            0x0000A000UL
+#define DEFAULT_END             0x0000FC00UL
+
+#define MAX_LINE                600     // 255 data bytes and then some
+
+
+//******************************************************************************
+//******************************************************************************
+// Global Data
+//******************************************************************************
+//******************************************************************************
+
+static unsigned long    base    = DEFAULT_BASE;
+static unsigned long    end     = DEFAULT_END;
+static unsigned long    version = 0;
+
+// Program memory from base to end, and which bytes the hex file gave
+static unsigned char   *image;
+static unsigned char   *used;
+
+static unsigned long    dropped;        // Data bytes outside of base..end
+
+
+//******************************************************************************
+//******************************************************************************
+// Local Routines
+//******************************************************************************
+//******************************************************************************
+
+/****************************************************************************
+  Function:
+    int HexByte ( const char *p )
+
+  Description:
+    Converts two hex digits.
+
+  Parameters:
+    p           - Pointer to the digits
+
+  Returns:
+    0 to 255, or -1 if p does not point to two hex digits
+***************************************************************************/
+
+static int HexByte ( const char *p )
+{
+    int     value = 0;
+    int     i;
+
+    for (i = 0; i < 2; i++)
+    {
+        value <<= 4;
+        if (p[i] >= '0' && p[i] <= '9')
+            value |= p[i] - '0';
+        else if (p[i] >= 'A' && p[i] <= 'F')
+            value |= p[i] - 'A' + 10;
+        else if (p[i] >= 'a' && p[i] <= 'f')
+            value |= p[i] - 'a' + 10;
+        else
+            return -1;
+    }
+    return value;
+
+} // HexByte
+
+
+/****************************************************************************
+  Function:
+    int ReadHex ( const char *path )
+
+  Description:
+    Reads an Intel HEX file into the image.  Handles data, end of file,
+    extended segment address and extended linear address records; start
+    address records are ignored.
+
+  Parameters:
+    path        - Name of the hex file
+
+  Returns:
+    0 on success, -1 after printing an error
+***************************************************************************/
+
+static int ReadHex ( const char *path )
+{
+    FILE           *f;
+    char            line[MAX_LINE];
+    unsigned char   record[MAX_LINE / 2];
+    unsigned long   upper = 0;      // Address bits from type 02 / 04 records
+    unsigned long   address;
+    unsigned char   sum;
+    size_t          length;
+    int             lineNumber = 0;
+    int             value;
+    int             eof = 0;
+    int             i, n;
+
+    f = fopen(path, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "hex2blf: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    while (!eof && fgets(line, sizeof(line), f) != NULL)
+    {
+        lineNumber++;
+
+        length = strcspn(line, "\r\n");
+        line[length] = 0;
+        if (length == 0)
+            continue;
+
+        if (line[0] != ':' || length < 11 || (length & 1) == 0)
+        {
+            fprintf(stderr, "hex2blf: %s:%d: not a hex record\n", path, lineNumber);
+            fclose(f);
+            return -1;
+        }
+
+        // Decode and check the record: length, address (2), type, data, checksum
+        n = (int)(length - 1) / 2;
+        sum = 0;
+        for (i = 0; i < n; i++)
+        {
+            value = HexByte(&line[1 + 2 * i]);
+            if (value < 0)
+            {
+                fprintf(stderr, "hex2blf: %s:%d: not a hex record\n", path, lineNumber);
+                fclose(f);
+                return -1;
+            }
+            record[i] = (unsigned char)value;
+            sum += record[i];
+        }
+
+        if (record[0] + 5 != n)
+        {
+            fprintf(stderr, "hex2blf: %s:%d: record length mismatch\n", path, lineNumber);
+            fclose(f);
+            return -1;
+        }
+
+        if (sum != 0)
+        {
+            fprintf(stderr, "hex2blf: %s:%d: checksum mismatch\n", path, lineNumber);
+            fclose(f);
+            return -1;
+        }
+
+        switch (record[3])
+        {
+        case 0x00:  // data
+            address = upper + ((unsigned long)record[1] << 8) + record[2];
+            for (i = 0; i < record[0]; i++, address++)
+            {
+                if (address >= base && address < end)
+                {
+                    image[address - base] = record[4 + i];
+                    used[address - base]  = 1;
+                }
+                else
+                {
+                    dropped++;
+                }
+            }
+            break;
+
+        case 0x01:  // end of file
+            eof = 1;
+            break;
+
+        case 0x02:  // extended segment address
+            upper = (((unsigned long)record[4] << 8) + record[5]) << 4;
+            break;
+
+        case 0x04:  // extended linear address
+            upper = (((unsigned long)record[4] << 8) + record[5]) << 16;
+            break;
+
+        case 0x03:  // start segment address
+        case 0x05:  // start linear address
+            break;
+
+        default:
+            fprintf(stderr, "hex2blf: %s:%d: unsupported record type %02X\n", path, lineNumber, record[3]);
+            fclose(f);
+            return -1;
+        }
+    }
+
+    fclose(f);
+
+    if (!eof)
+    {
+        fprintf(stderr, "hex2blf: %s: no end of file record\n", path);
+        return -1;
+    }
+    return 0;
+
+} // ReadHex
+
+
+/****************************************************************************
+  Function:
+    unsigned long Crc32 ( const unsigned char *p, unsigned long length )
+
+  Description:
+    CRC-32 of the payload, as the boot loader computes it.
+***************************************************************************/
+
+static unsigned long Crc32 ( const unsigned char *p, unsigned long length )
+{
+    unsigned long   crc = BLF_CRC_INITIAL;
+    int             bit;
+
+    while (length-- > 0)
+    {
+        crc ^= *p++;
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc & 1) ? (crc >> 1) ^ BLF_CRC_POLYNOMIAL : crc >> 1;
+    }
+    return (crc ^ BLF_CRC_INITIAL) & 0xFFFFFFFFUL;
+
+} // Crc32
+
+
+/****************************************************************************
+  Function:
+    void PutField ( unsigned char *p, unsigned long value, int size )
+
+  Description:
+    Stores a little endian header field.
+***************************************************************************/
+
+static void PutField ( unsigned char *p, unsigned long value, int size )
+{
+    int     i;
+
+    for (i = 0; i < size; i++)
+    {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+
+} // PutField
+
+
+/****************************************************************************
+  Function:
+    int ParseNumber ( const char *text, unsigned long *value )
+
+  Description:
+    Reads a command line number, decimal or 0x hex.
+
+  Returns:
+    0 on success, -1 if text is not a number
+***************************************************************************/
+
+static int ParseNumber ( const char *text, unsigned long *value )
+{
+    char   *stop;
+
+    errno  = 0;
+    *value = strtoul(text, &stop, 0);
+    return (errno != 0 || *text == 0 || *stop != 0) ? -1 : 0;
+
+} // ParseNumber
+
+
+static void Usage ( void )
+{
+    fprintf(stderr, "usage: hex2blf [-b base] [-e end] [-v version] image.hex image.blf\n");
+    exit(2);
+}
+
+
+int main ( int argc, char *argv[] )
+{
+    unsigned char   header[BLF_HEADER_SIZE];
+    unsigned long   first, last, length, given, crc;
+    unsigned long   i;
+    FILE           *f;
+    int             arg;
+
+    for (arg = 1; arg < argc && argv[arg][0] == '-'; arg += 2)
+    {
+        unsigned long *option;
+
+        if (strcmp(argv[arg], "-b") == 0)
+            option = &base;
+        else if (strcmp(argv[arg], "-e") == 0)
+            option = &end;
+        else if (strcmp(argv[arg], "-v") == 0)
+            option = &version;
+        else
+            Usage();
+
+        if (arg + 1 >= argc || ParseNumber(argv[arg + 1], option) != 0)
+            Usage();
+    }
+    if (argc - arg != 2)
+        Usage();
+
+    if (base % BLF_ROW_SIZE || end % BLF_ROW_SIZE || end <= base)
+    {
+        fprintf(stderr, "hex2blf: base and end must be multiples of %d, base below end\n", BLF_ROW_SIZE);
+        return 1;
+    }
+
+    image = malloc(end - base);
+    used  = calloc(end - base, 1);
+    if (image == NULL || used == NULL)
+    {
+        fprintf(stderr, "hex2blf: out of memory\n");
+        return 1;
+    }
+    memset(image, 0xFF, end - base);
+
+    if (ReadHex(argv[arg]) != 0)
+        return 1;
+
+    // Payload: the rows from the first to the last byte given
+    for (first = 0; first < end - base && !used[first]; first++)
+        ;
+    if (first == end - base)
+    {
+        fprintf(stderr, "hex2blf: %s: no data from 0x%lX to 0x%lX\n", argv[arg], base, end);
+        return 1;
+    }
+    for (last = end - base; !used[last - 1]; last--)
+        ;
+    first  &= ~(unsigned long)(BLF_ROW_SIZE - 1);
+    last    = (last + BLF_ROW_SIZE - 1) & ~(unsigned long)(BLF_ROW_SIZE - 1);
+    length  = last - first;
+
+    for (given = 0, i = first; i < last; i++)
+        given += used[i];
+    crc = Crc32(&image[first], length);
+
+    memset(header, 0xFF, sizeof(header));
+    header[BLF_OFFSET_MAGIC + 0] = BLF_MAGIC_0;
+    header[BLF_OFFSET_MAGIC + 1] = BLF_MAGIC_1;
+    header[BLF_OFFSET_MAGIC + 2] = BLF_MAGIC_2;
+    header[BLF_OFFSET_MAGIC + 3] = BLF_MAGIC_3;
+    PutField(&header[BLF_OFFSET_FORMAT],     BLF_FORMAT_VERSION, 2);
+    PutField(&header[BLF_OFFSET_HEADER_LEN], BLF_HEADER_SIZE, 2);
+    PutField(&header[BLF_OFFSET_ADDRESS],    base + first, 4);
+    PutField(&header[BLF_OFFSET_LENGTH],     length, 4);
+    PutField(&header[BLF_OFFSET_VERSION],    version, 4);
+    PutField(&header[BLF_OFFSET_CRC],        crc, 4);
+
+    f = fopen(argv[arg + 1], "wb");
+    if (f == NULL
+        || fwrite(header, 1, sizeof(header), f) != sizeof(header)
+        || fwrite(&image[first], 1, length, f) != length
+        || fclose(f) != 0)
+    {
+        fprintf(stderr, "hex2blf: %s: %s\n", argv[arg + 1], strerror(errno));
+        return 1;
+    }
+
+    printf("%s: 0x%lX-0x%lX, %lu bytes (%lu from the hex file), CRC-32 %08lX\n",
+           argv[arg + 1], base + first, base + last, length, given, crc);
+    if (dropped > 0)
+    {
+        fprintf(stderr, "hex2blf: warning: %lu bytes outside 0x%lX-0x%lX dropped\n", dropped, base, end);
+    }
+    return 0;
+
+} // main
+
+
+/*
+*******************************************************************************
+EOF
+*******************************************************************************
+*/
@@ -0,0 +1,207 @@
+/*
+*******************************************************************************
+hextest - host test of the boot loader hex parser (boot_load_hex.c)
+
+    hextest [-n mutations] [-s seed] image.hex
+
+The file is first decoded in a single piece to get the reference image.
+It is then decoded again in pieces of 1, 40 and 700 bytes and in pieces
+of random length, each of which must give the same image.  Last, the
+file is decoded with one byte changed at random, mutations times
+(default 5000); the parser may reject the changed file, but if it
+accepts it the image must still match the reference.
+
+Exits with 0 if every pass succeeded and 1 otherwise.
+*******************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "GenericTypedefs.h"
+#include "../boot.h"
+
+#define DEFAULT_MUTATIONS       5000
+#define DEFAULT_SEED            1
+
+#define MEMORY_SIZE             0x10000UL   // Program Flash of the 46J50
+#define MAX_FILE                0x40000UL
+
+volatile BOOT_STATUS BootStatus;            // Set by BLIO_ReportBootStatus
+
+static BYTE  memory[MEMORY_SIZE];           // Image the sink has written
+static DWORD outside;                       // Hash of data beyond memory
+
+
+/******************************************************************************
+    Stores a decoded block into the image.  Data outside program Flash
+    (the configuration words, say) is folded into a hash so that it is
+    compared as well.
+*/
+
+static void Sink ( DWORD address, BYTE *pData, BYTE length )
+{
+    while (length--)
+    {
+        if (address < MEMORY_SIZE)
+        {
+            memory[address] = *pData;
+        }
+        else
+        {
+            outside = (outside * 31 + address) * 31 + *pData;
+        }
+        address++;
+        pData++;
+    }
+}
+
+
+/******************************************************************************
+    Decodes a whole file, piece by piece.  A piece is fixed bytes long or,
+    if fixed is 0, of random length from 1 to 700.  Returns the last
+    Loader_HexDecode result and leaves the image in memory and outside.
+*/
+
+static BYTE Decode ( BYTE *file, size_t size, size_t fixed )
+{
+    size_t  position;
+    size_t  piece;
+    BYTE    result;
+
+    memset(memory, 0xFF, sizeof(memory));
+    outside = 0;
+    Loader_HexInit(Sink);
+
+    result   = LOADER_NEED_DATA;
+    position = 0;
+    while (position < size && result == LOADER_NEED_DATA)
+    {
+        piece = fixed ? fixed : 1 + rand() % 700;
+        if (piece > size - position)
+        {
+            piece = size - position;
+        }
+        result    = Loader_HexDecode(file + position, (WORD)piece);
+        position += piece;
+    }
+
+    return result;
+}
+
+
+int main ( int argc, char *argv[] )
+{
+    static BYTE file[MAX_FILE];
+    static BYTE changed[MAX_FILE];
+    static BYTE reference[MEMORY_SIZE];
+    static const size_t pieces[] = { 1, 40, 700 };
+    DWORD   referenceOutside;
+    long    mutations = DEFAULT_MUTATIONS;
+    long    rejected;
+    long    trial;
+    size_t  size;
+    size_t  i;
+    unsigned seed = DEFAULT_SEED;
+    FILE   *in;
+    int     failures = 0;
+    int     arg;
+
+    for (arg = 1; arg < argc - 1 && argv[arg][0] == '-'; arg += 2)
+    {
+        if (strcmp(argv[arg], "-n") == 0)
+        {
+            mutations = strtol(argv[arg + 1], NULL, 0);
+        }
+        else if (strcmp(argv[arg], "-s") == 0)
+        {
+            seed = (unsigned)strtoul(argv[arg + 1], NULL, 0);
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (arg != argc - 1)
+    {
+        fprintf(stderr, "usage: hextest [-n mutations] [-s seed] image.hex\n");
+        return 1;
+    }
+
+    in = fopen(argv[arg], "rb");
+    if (in == NULL)
+    {
+        fprintf(stderr, "hextest: %s: %s\n", argv[arg], strerror(errno));
+        return 1;
+    }
+    size = fread(file, 1, sizeof(file), in);
+    fclose(in);
+    if (size == 0 || size == sizeof(file))
+    {
+        fprintf(stderr, "hextest: %s: empty or too large\n", argv[arg]);
+        return 1;
+    }
+    srand(seed);
+
+    // Reference: the whole file in one piece
+    if (Decode(file, size, size) != LOADER_EOF)
+    {
+        fprintf(stderr, "hextest: %s does not decode in one piece\n", argv[arg]);
+        return 1;
+    }
+    memcpy(reference, memory, sizeof(reference));
+    referenceOutside = outside;
+
+    // Split into fixed and random pieces
+    for (i = 0; i <= sizeof(pieces) / sizeof(pieces[0]); i++)
+    {
+        size_t fixed = i < sizeof(pieces) / sizeof(pieces[0]) ? pieces[i] : 0;
+
+        for (trial = 0; trial < (fixed ? 1 : 100); trial++)
+        {
+            if (Decode(file, size, fixed) != LOADER_EOF ||
+                memcmp(memory, reference, sizeof(memory)) != 0 ||
+                outside != referenceOutside)
+            {
+                if (fixed)
+                    printf("FAIL: %lu byte pieces\n", (unsigned long)fixed);
+                else
+                    printf("FAIL: random pieces, trial %ld\n", trial);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    // Change one byte at a time
+    rejected = 0;
+    for (trial = 0; trial < mutations; trial++)
+    {
+        size_t position = rand() % size;
+        BYTE   original = file[position];
+
+        memcpy(changed, file, size);
+        do
+        {
+            changed[position] = (BYTE)rand();
+        } while (changed[position] == original);
+
+        if (Decode(changed, size, 0) != LOADER_EOF)
+        {
+            rejected++;
+        }
+        else if (memcmp(memory, reference, sizeof(memory)) != 0 ||
+                 outside != referenceOutside)
+        {
+            printf("FAIL: byte %lu changed from 0x%02X to 0x%02X was accepted\n",
+                   (unsigned long)position, original, changed[position]);
+            failures++;
+        }
+    }
+
+    printf("hextest: %s, %lu bytes, %ld of %ld changed files rejected, %d failures\n",
+           argv[arg], (unsigned long)size, rejected, mutations, failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,8 @@
+// Host stand-in for the Microchip Compiler.h: C18 rom data is plain const
+#ifndef __COMPILER_H
+#define __COMPILER_H
+
+#define rom                     const
+#define ROM                     const
+
+#endif
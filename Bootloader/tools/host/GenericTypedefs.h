@@ -0,0 +1,13 @@
+// Host stand-in for the Microchip GenericTypedefs.h, enough for hextest
+#ifndef __GENERIC_TYPE_DEFS_H_
+#define __GENERIC_TYPE_DEFS_H_
+
+#include <stdint.h>
+
+typedef enum _BOOL { FALSE = 0, TRUE } BOOL;
+
+typedef uint8_t                 BYTE;
+typedef uint16_t                WORD;
+typedef uint32_t                DWORD;
+
+#endif
@@ -0,0 +1 @@
+// Host stand-in for HardwareProfile.h: the loader decoders use no hardware
@@ -59,6 +59,8 @@
 
 #include "soft_start.h"
 
+#include "accel.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 //	========================	CONFIGURATION	========================
@@ -228,7 +230,12 @@ BOOL CheckButtonPressed(void);
 #endif
 
 
-static int counterX = 0, counterY = 0;				//global int for accY & accX max value
+static int counterX = 0, counterY = 0;				//global int for accY & accX max value, raw counts
+static BMA150_XYZ sample;							//latest X/Y/Z, one burst read per loop
+static BYTE sampleTemp;								//raw BMA150_TEMP from the same burst
+
+//Z below this (about -0.23 g) means the board has been flipped over
+#define ACCEL_FLIP_Z	ACCEL_MG_TO_RAW(-227)
 
 //	========================	Board Initialization Code	========================
 #pragma code
@@ -419,26 +426,16 @@ void accelerometer()
 {
 	BMA150_XYZ xyz;
 	char xyArr[20] = {0};	
-	BYTE lsb, msb;
-	int i, val, repeat = 0;
+	int i, repeat = 0;
 
 
 	//accX
 	for(i=13;i <= 40;i++)
 		oledWriteChar1x(0x20, 4 + 0xB0, i);						//clear garbage oled parameter
 
-	lsb = BMA150_ReadByte(BMA150_ACC_X_LSB); 	
-	msb = BMA150_ReadByte(BMA150_ACC_X_MSB); 	
-	xyz.x = 0;
-	xyz.x = (short)msb << 8;
-	xyz.x |= lsb;
-	xyz.x >>= 6;
-	if(xyz.x & 0x200)
-		xyz.x |= 0xFC00;
+	xyz = sample;
 
-	xyz.x = xyz.x << 2;		
-	
-	itoa(xyz.x, xyArr);
+	itoa(BMA150_ToMilliG(xyz.x), xyArr);
 	oledPutROMString((ROM_STRING)"X: ",4,0);
 	oledPutString(xyArr, 4, 15);
 
@@ -446,32 +443,20 @@ void accelerometer()
 	for(i=55;i <= 110;i++)
 		oledWriteChar1x(0x20, 4 + 0xB0, i);
 
-	val = atoi(xyArr);
-	if(val > counterX)
-		counterX = val;
+	if(xyz.x > counterX)
+		counterX = xyz.x;
 	
 	//graph bar X
 	oledWriteChar1x(0x5B, 4 + 0xB0,50);
 	oledWriteChar1x(0x5D, 4 + 0xB0,100);
-	repeat = counterX / 50;
+	repeat = counterX * 2 / 25;						//(counts * 4) / 50
 	oledRepeatByte(0x18,4,55, repeat);
 
 	//accY
 	for(i=13;i <= 40;i++)
 		oledWriteChar1x(0x20, 5 + 0xB0, i);
 
-	lsb = BMA150_ReadByte(BMA150_ACC_Y_LSB); 	
-	msb = BMA150_ReadByte(BMA150_ACC_Y_MSB); 	
-	xyz.y = 0;
-	xyz.y = (short)msb << 8;
-	xyz.y |= lsb;
-	xyz.y >>= 6;
-	if(xyz.y & 0x200)
-		xyz.y |= 0xFC00;
-
-	xyz.x = xyz.x << 2;
-
-	itoa(xyz.y, xyArr);
+	itoa(BMA150_ToMilliG(xyz.y), xyArr);
 	oledPutROMString((ROM_STRING)"Y: ",5,0);
 	oledPutString(xyArr, 5, 15);
 
@@ -479,31 +464,18 @@ void accelerometer()
 	for(i=55;i <= 120;i++)
 		oledWriteChar1x(0x20, 5 + 0xB0, i);
 
-	val = atoi(xyArr);
-	if(val > counterY)
-		counterY = val;
+	if(xyz.y > counterY)
+		counterY = xyz.y;
 
 	//graph bar Y
 	oledWriteChar1x(0x5B, 5 + 0xB0,50);
 	oledWriteChar1x(0x5D, 5 + 0xB0,100);
-	repeat = counterY / 11.2;
+	repeat = counterY * 5 / 56;						//counts / 11.2
 	oledRepeatByte(0x18,5,55, repeat);
 
 	//z
-	lsb = BMA150_ReadByte(BMA150_ACC_Z_LSB); //LSB	
-	msb = BMA150_ReadByte(BMA150_ACC_Z_MSB); //MSB	
-	xyz.z = 0;
-	xyz.z = (short)msb << 8;
-	xyz.z |= lsb;
-	xyz.z >>= 6;
-	if(xyz.z & 0x200)
-		xyz.z |= 0xFC00;
-
-	itoa(xyz.z, xyArr);
-	val = atoi(xyArr);
-
 	//chack if microchip is upside down
-	if(val < -58)
+	if(xyz.z < ACCEL_FLIP_Z)
 	{
 		counterY = 0;
 		counterX = 0;
@@ -515,13 +487,9 @@ void accelerometer()
 
 void temperature()
 {
-	int temperature;
 	char str[20];	
 
-	temperature = BMA150_ReadByte(BMA150_TEMP);
-	temperature = (temperature - 32) / 1.8;
-
-	itoa(temperature, str);
+	Accel_FormatDeci(BMA150_ToDeciC(sampleTemp), str);
 
 	oledPutROMString((ROM_STRING)"Temp: ",7,0);
  	oledPutString(str, 7, 35);
@@ -565,6 +533,9 @@ void main(void)
 		/**************************************L\R & scroll************************************/
 		touchButtons();
 
+		/**************************************BMA150 X/Y/Z + temperature, one burst********/
+		sampleTemp = BMA150_ReadXYZT(&sample);
+
 		/******************************************temperature*********************************/
 		temperature();
 
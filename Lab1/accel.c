@@ -0,0 +1,348 @@
+/********************************************************************
+  File Information:
+    FileName:     	accel.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Accelerometer services, see accel.h
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "accel.h"
+#include <stdlib.h>
+/*********************************************/
+
+// The BMA150 shares MSSP2 with the SD card; InitBma150() configures it
+#define ACCEL_SPI_BUF			SSP2BUF
+#define ACCEL_SPI_BF			SSP2STATbits.BF
+#define ACCEL_CS				LATCbits.LATC7
+
+#define BMA150_SPI_READ			0x80
+
+static volatile BOOL dataReady;
+static BYTE quietCalls;						// BMA150_ReadFresh() calls since INT
+
+
+/*********************************************************************
+* Function:  static BYTE Accel_Transfer(BYTE data)
+*
+* Overview: clocks one byte out and returns the byte clocked in
+*
+********************************************************************/
+static BYTE Accel_Transfer(BYTE data)
+{
+	ACCEL_SPI_BUF = data;
+	while(!ACCEL_SPI_BF);
+	return ACCEL_SPI_BUF;
+}
+
+/*********************************************************************
+* Function:  static void Accel_ReadBurst(BYTE address, BYTE *data,
+*										 BYTE count)
+*
+* Overview: reads count consecutive registers starting at address in
+*			one chip-select window, relying on the BMA150 address
+*			auto-increment
+*
+********************************************************************/
+static void Accel_ReadBurst(BYTE address, BYTE *data, BYTE count)
+{
+	ACCEL_CS = 0;
+	Accel_Transfer(address | BMA150_SPI_READ);
+	while(count--)
+		*data++ = Accel_Transfer(0x00);
+	ACCEL_CS = 1;
+}
+
+/*********************************************************************
+* Function:  static BYTE Accel_ReadReg(BYTE address)
+*
+* Overview: reads one BMA150 register
+*
+********************************************************************/
+static BYTE Accel_ReadReg(BYTE address)
+{
+	BYTE data;
+
+	Accel_ReadBurst(address, &data, 1);
+	return data;
+}
+
+/*********************************************************************
+* Function:  static void Accel_ModifyReg(BYTE address, BYTE clear,
+*										 BYTE set)
+*
+* Overview: read-modify-write of one BMA150 register, so the reserved
+*			and factory bits sharing it are left alone
+*
+********************************************************************/
+static void Accel_ModifyReg(BYTE address, BYTE clear, BYTE set)
+{
+	BYTE data;
+
+	data = (Accel_ReadReg(address) & ~clear) | set;
+
+	ACCEL_CS = 0;
+	Accel_Transfer(address & ~BMA150_SPI_READ);
+	Accel_Transfer(data);
+	ACCEL_CS = 1;
+}
+
+/*********************************************************************
+* Function:  void Accel_InitInterrupts(void)
+*
+* PreCondition: InitBma150() has been called
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: maps INT1 to ACCEL_INT_RP and enables its interrupt
+*
+* Overview: sets the 25 Hz bandwidth, loads the any-motion settings
+*			and starts in data-ready mode: the BMA150 pulses INT for
+*			each new sample
+*
+********************************************************************/
+void Accel_InitInterrupts(void)
+{
+	BYTE gie;
+
+	Accel_ModifyReg(BMA150_REG_RANGE_BW, BMA150_BANDWIDTH_MASK, BMA150_BANDWIDTH_25HZ);
+	Accel_ModifyReg(BMA150_REG_MOTION_THRES, 0xFF, ACCEL_MOTION_THRES);
+	Accel_ModifyReg(BMA150_REG_MOTION_DUR, 0xC0, ACCEL_MOTION_DUR << 6);
+
+	ACCEL_INT_TRIS = 1;
+
+	gie = INTCONbits.GIE;
+	INTCONbits.GIE = 0;
+	EECON2 = 0x55;								// PPS unlock sequence
+	EECON2 = 0xAA;
+	PPSCONbits.IOLOCK = 0;
+	RPINR1 = ACCEL_INT_RP;
+	EECON2 = 0x55;
+	EECON2 = 0xAA;
+	PPSCONbits.IOLOCK = 1;
+	INTCONbits.GIE = gie;
+
+	INTCON2bits.INTEDG1 = 1;					// INT is active high
+	Accel_ArmDataReady();
+}
+
+/*********************************************************************
+* Function:  void Accel_ISR(void)
+*
+* PreCondition: INTCON3bits.INT1IF is set
+*
+* Overview: records that the BMA150 has something new for us
+*
+********************************************************************/
+void Accel_ISR(void)
+{
+	INTCON3bits.INT1IF = 0;
+	dataReady = TRUE;
+}
+
+/*********************************************************************
+* Function:  BOOL BMA150_ReadFresh(BMA150_XYZ *xyz)
+*
+* Input: xyz - receives the axis values when a new sample exists
+*
+* Output: TRUE if xyz was updated, FALSE if the BMA150 has not
+*		  converted since the last call (xyz untouched)
+*
+* Overview: normally only checks the INT flag. After
+*			ACCEL_INT_QUIET_CALLS calls without INT, reads the axes
+*			on every call and keeps them if new_data_x is set, so
+*			the UI still gets samples if INT is not wired up.
+*
+********************************************************************/
+BOOL BMA150_ReadFresh(BMA150_XYZ *xyz)
+{
+	BYTE raw[BMA150_XYZ_BYTES];
+
+	if(dataReady)
+	{
+		dataReady = FALSE;
+		quietCalls = 0;
+		BMA150_ReadXYZ(xyz);
+		return TRUE;
+	}
+
+	if(quietCalls < ACCEL_INT_QUIET_CALLS)
+	{
+		quietCalls++;
+		return FALSE;
+	}
+
+	Accel_ReadBurst(BMA150_ACC_X_LSB, raw, BMA150_XYZ_BYTES);
+	if(!(raw[0] & BMA150_NEW_DATA_X))
+		return FALSE;
+
+	xyz->x = BMA150_SignExtend10(raw[0], raw[1]);
+	xyz->y = BMA150_SignExtend10(raw[2], raw[3]);
+	xyz->z = BMA150_SignExtend10(raw[4], raw[5]);
+	return TRUE;
+}
+
+/*********************************************************************
+* Function:  BOOL Accel_ArmMotionWake(void)
+*
+* Output: TRUE if the INT line is quiet and it is safe to Sleep()
+*
+* Side Effects: new-data pulses stop until Accel_ArmDataReady()
+*
+* Overview: routes the any-motion detector to INT, so the next INT1
+*			edge means the board was moved
+*
+********************************************************************/
+BOOL Accel_ArmMotionWake(void)
+{
+	INTCON3bits.INT1IE = 0;
+
+	Accel_ModifyReg(BMA150_REG_INT_CTRL, BMA150_NEW_DATA_INT, BMA150_ADV_INT);
+	Accel_ModifyReg(BMA150_REG_INT_EN, 0, BMA150_ANY_MOTION);
+
+	INTCON3bits.INT1IF = 0;
+	INTCON3bits.INT1IE = 1;
+
+	return !ACCEL_INT_PIN;
+}
+
+/*********************************************************************
+* Function:  BOOL Accel_MovedSince(BMA150_XYZ *rest)
+*
+* Input: rest - axis values read before the MCU went to sleep
+*
+* Output: TRUE if an axis now differs from rest by more than the
+*		  any-motion threshold
+*
+* Overview: lets a watchdog wake-up check for motion the INT line
+*			did not report
+*
+********************************************************************/
+BOOL Accel_MovedSince(BMA150_XYZ *rest)
+{
+	BMA150_XYZ xyz;
+
+	BMA150_ReadXYZ(&xyz);
+
+	return abs(xyz.x - rest->x) > ACCEL_MG_TO_RAW(ACCEL_MOTION_MG) ||
+		   abs(xyz.y - rest->y) > ACCEL_MG_TO_RAW(ACCEL_MOTION_MG) ||
+		   abs(xyz.z - rest->z) > ACCEL_MG_TO_RAW(ACCEL_MOTION_MG);
+}
+
+/*********************************************************************
+* Function:  void Accel_ArmDataReady(void)
+*
+* Overview: turns the any-motion output off again and routes the
+*			new-data pulse to INT. The next BMA150_ReadFresh() always
+*			reads, since samples may have been missed meanwhile.
+*
+********************************************************************/
+void Accel_ArmDataReady(void)
+{
+	INTCON3bits.INT1IE = 0;
+
+	Accel_ModifyReg(BMA150_REG_INT_EN, BMA150_ANY_MOTION, 0);
+	Accel_ModifyReg(BMA150_REG_INT_CTRL, BMA150_ADV_INT, BMA150_NEW_DATA_INT);
+
+	INTCON3bits.INT1IF = 0;
+	dataReady = TRUE;
+	INTCON3bits.INT1IE = 1;
+}
+
+/*********************************************************************
+* Function:  void BMA150_ReadXYZ(BMA150_XYZ *xyz)
+*
+* PreCondition: InitBma150() has been called
+*
+* Input: xyz - receives the sign extended 10 bit axis values
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: burst reads BMA150_ACC_X_LSB..BMA150_ACC_Z_MSB
+*
+********************************************************************/
+void BMA150_ReadXYZ(BMA150_XYZ *xyz)
+{
+	BYTE raw[BMA150_XYZ_BYTES];
+
+	Accel_ReadBurst(BMA150_ACC_X_LSB, raw, BMA150_XYZ_BYTES);
+
+	xyz->x = BMA150_SignExtend10(raw[0], raw[1]);
+	xyz->y = BMA150_SignExtend10(raw[2], raw[3]);
+	xyz->z = BMA150_SignExtend10(raw[4], raw[5]);
+}
+
+/*********************************************************************
+* Function:  BYTE BMA150_ReadXYZT(BMA150_XYZ *xyz)
+*
+* PreCondition: InitBma150() has been called
+*
+* Input: xyz - receives the sign extended 10 bit axis values
+*
+* Output: raw BMA150_TEMP register
+*
+* Side Effects: none
+*
+* Overview: same as BMA150_ReadXYZ() but extends the burst by one
+*			register to pick up the temperature as well
+*
+********************************************************************/
+BYTE BMA150_ReadXYZT(BMA150_XYZ *xyz)
+{
+	BYTE raw[BMA150_XYZT_BYTES];
+
+	Accel_ReadBurst(BMA150_ACC_X_LSB, raw, BMA150_XYZT_BYTES);
+
+	xyz->x = BMA150_SignExtend10(raw[0], raw[1]);
+	xyz->y = BMA150_SignExtend10(raw[2], raw[3]);
+	xyz->z = BMA150_SignExtend10(raw[4], raw[5]);
+
+	return raw[6];
+}
+
+/*********************************************************************
+* Function:  void Accel_FormatDeci(SHORT value, char *str)
+*
+* Input: value - fixed point value in tenths (e.g. BMA150_ToDeciC())
+*		 str   - receives the text, at least 8 bytes
+*
+* Output: none
+*
+* Overview: prints value as [-]integer.tenth without going through
+*			the floating point formatter
+*
+********************************************************************/
+void Accel_FormatDeci(SHORT value, char *str)
+{
+	WORD magnitude;
+
+	if(value < 0)
+	{
+		*str++ = '-';
+		magnitude = (WORD)(-value);
+	}
+	else
+		magnitude = (WORD)value;
+
+	itoa((int)(magnitude / 10), str);
+	while(*str)
+		str++;
+	*str++ = '.';
+	*str++ = '0' + (magnitude % 10);
+	*str = 0;
+}
@@ -0,0 +1,142 @@
+/********************************************************************
+  File Information:
+    FileName:     	accel.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Accelerometer services layered on top of the Microchip BMA150
+    driver. BMA150_ReadXYZ() fetches all three axes (and optionally
+    the temperature) with a single auto-incrementing SPI read instead
+    of one chip-select/address phase per register.
+
+    The BMA150 INT output is routed to INT1 through peripheral pin
+    select. While awake the chip raises it for every new sample, so
+    the UI reads the axes only when BMA150_ReadFresh() reports fresh
+    data. If INT stays quiet, BMA150_ReadFresh() polls the chip's
+    new data flag instead. Before the MCU sleeps, Accel_ArmMotionWake() switches the pin
+    over to the any-motion detector so moving the board wakes it up;
+    Accel_ArmDataReady() switches back afterwards.
+
+    The conversions to milli-g and tenths of a degree are integer
+    only; every scale factor below folds to a constant at compile
+    time so no floating point support is linked in.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef ACCEL_H
+#define ACCEL_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "BMA150.h"
+/*********************************************/
+
+// Number of registers from BMA150_ACC_X_LSB up to and including BMA150_TEMP
+#define BMA150_XYZ_BYTES		6
+#define BMA150_XYZT_BYTES		7
+
+/*********************************************************************
+* Macro:  SHORT BMA150_SignExtend10(BYTE lsb, BYTE msb)
+*
+* Overview: assembles a 10 bit two's complement axis value from its
+*			LSB register (bits 7:6) and MSB register (bits 9:2) and
+*			sign extends it to 16 bits
+*
+********************************************************************/
+#define BMA150_SignExtend10(lsb, msb) \
+	((SHORT)(((((WORD)(msb) << 2) | ((BYTE)(lsb) >> 6)) ^ 0x0200) - 0x0200))
+
+// Full scale range left in BMA150_RANGE by InitBma150() (+/-2 g)
+#define ACCEL_RANGE_G			2
+#define ACCEL_LSB_PER_G			(512 / ACCEL_RANGE_G)
+
+// milli-g = raw * ACCEL_MG_SCALE >> ACCEL_MG_SHIFT (3.906 mg/LSB at 2 g)
+#define ACCEL_MG_SHIFT			8
+#define ACCEL_MG_SCALE			((WORD)((1000UL << ACCEL_MG_SHIFT) / ACCEL_LSB_PER_G))
+
+// BMA150_TEMP: 0.5 K per LSB, a reading of 0 is -30 C
+#define ACCEL_DECIC_PER_LSB		5
+#define ACCEL_DECIC_OFFSET		(-300)
+
+/*********************************************************************
+* Macro:  SHORT BMA150_ToMilliG(SHORT raw)
+*
+* Overview: scales a sign extended axis value to milli-g
+*
+********************************************************************/
+#define BMA150_ToMilliG(raw) \
+	((SHORT)(((LONG)(raw) * ACCEL_MG_SCALE) >> ACCEL_MG_SHIFT))
+
+/*********************************************************************
+* Macro:  SHORT ACCEL_MG_TO_RAW(mg)
+*
+* Overview: converts a constant milli-g threshold to raw axis counts
+*			at compile time, so comparisons need no conversion at run
+*			time
+*
+********************************************************************/
+#define ACCEL_MG_TO_RAW(mg) \
+	((SHORT)(((LONG)(mg) * ACCEL_LSB_PER_G) / 1000))
+
+/*********************************************************************
+* Macro:  SHORT BMA150_ToDeciC(BYTE raw)
+*
+* Overview: converts the BMA150_TEMP register to tenths of a degree C
+*
+********************************************************************/
+#define BMA150_ToDeciC(raw) \
+	((SHORT)((SHORT)(BYTE)(raw) * ACCEL_DECIC_PER_LSB + ACCEL_DECIC_OFFSET))
+
+// Remappable pin carrying the BMA150 INT line, and its port bit.
+// On the PIC18F Starter Kit schematic BMA150 INT goes to RB1/RP4;
+// RC6 and RC7 are the SD card and BMA150 chip selects. Change all
+// three together for a board that routes the line elsewhere.
+#define ACCEL_INT_RP			4
+#define ACCEL_INT_PIN			PORTBbits.RB1
+#define ACCEL_INT_TRIS			TRISBbits.TRISB1
+
+// BMA150_ReadFresh() calls without an INT pulse before it falls back
+// to polling the new_data_x flag (bit 0 of BMA150_ACC_X_LSB)
+#define ACCEL_INT_QUIET_CALLS	5
+#define BMA150_NEW_DATA_X		0x01
+
+// BMA150 control registers used for the interrupt output
+#define BMA150_REG_INT_EN		0x0B		// any_motion is bit 6
+#define BMA150_REG_MOTION_THRES	0x10
+#define BMA150_REG_MOTION_DUR	0x11		// any_motion_dur is bits 7:6
+#define BMA150_REG_INT_CTRL		0x15		// enable_adv_INT bit 6, new_data_int bit 5
+#define BMA150_REG_RANGE_BW		0x14		// range bits 4:3, bandwidth bits 2:0
+
+// 25 Hz bandwidth, which gives new data (and INT pulses) at 50 Hz; the
+// gesture timing and the 50 Hz accelerometer task depend on it
+#define BMA150_BANDWIDTH_MASK	0x07
+#define BMA150_BANDWIDTH_25HZ	0x00
+
+#define BMA150_ANY_MOTION		0x40
+#define BMA150_ADV_INT			0x40
+#define BMA150_NEW_DATA_INT		0x20
+
+// Wake-up threshold; the register counts 15.6 mg steps at +/-2 g.
+// ACCEL_MOTION_DUR 0..3 requires the motion on 1, 3, 5 or 7 samples.
+#define ACCEL_MOTION_MG			150
+#define ACCEL_MOTION_THRES		((BYTE)(((LONG)ACCEL_MOTION_MG * 64 * 2 / ACCEL_RANGE_G) / 1000))
+#define ACCEL_MOTION_DUR		1
+
+void Accel_InitInterrupts(void);
+void Accel_ISR(void);
+BOOL BMA150_ReadFresh(BMA150_XYZ *xyz);
+BOOL Accel_ArmMotionWake(void);
+BOOL Accel_MovedSince(BMA150_XYZ *rest);
+void Accel_ArmDataReady(void);
+
+void BMA150_ReadXYZ(BMA150_XYZ *xyz);
+BYTE BMA150_ReadXYZT(BMA150_XYZ *xyz);
+void Accel_FormatDeci(SHORT value, char *str);
+
+#endif
@@ -0,0 +1,280 @@
+/********************************************************************
+  File Information:
+    FileName:     	adc_sched.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    The converter runs a fixed schedule of slots:
+
+      POT x ADC_POT_OVERSAMPLE, TOUCH 0, TOUCH 1, TOUCH 2, TOUCH 3
+
+    Pot conversions are started by the ECCP2 special event trigger
+    (Timer1 compare), so they cost one short interrupt each. Touch
+    conversions need the pad charged by the CTMU right before the
+    sample, so the interrupt charges the pad and sets GO itself while
+    the special event trigger is parked.
+
+    Results are published to the UI through the accessors below;
+    nothing outside this file may touch ADCON0 once AdcSched_Init()
+    has run.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "adc_sched.h"
+/*********************************************/
+
+// Timer1 runs from Fosc/4 (12 MHz) through a 1:8 prescaler
+#define ADC_TIMER1_CLOCK		(12000000 / 8)
+#define ADC_TRIGGER_PERIOD		(ADC_TIMER1_CLOCK / ADC_TRIGGER_HZ)
+
+#define ADC_SLOT_POT			0			// slots 1..ADC_TOUCH_CHANNELS are the pads
+
+#define CCP2_SPECIAL_EVENT		0x0B		// compare mode, reset Timer1 and start A/D
+#define CCP2_OFF				0x00
+
+static rom BYTE touchChannel[ADC_TOUCH_CHANNELS] = { 0, 1, 2, 3 };
+
+static BYTE slot;
+static BYTE potCount;
+static WORD potAccum;
+
+static volatile WORD potValue;
+static volatile BYTE potSequence;
+static volatile WORD touchValue[ADC_TOUCH_CHANNELS];
+static volatile BOOL touchReady;
+
+
+/*********************************************************************
+* Function:  static void AdcSched_StartTouch(BYTE channel)
+*
+* Overview: charges the selected pad from the CTMU current source and
+*			starts its conversion. Called from the A/D interrupt.
+*
+********************************************************************/
+static void AdcSched_StartTouch(BYTE channel)
+{
+	BYTE i;
+
+	ADCON0bits.CHS = touchChannel[channel];
+
+	CTMUCONHbits.IDISSEN = 1;					// drain the pad
+	Nop(); Nop(); Nop(); Nop();
+	CTMUCONHbits.IDISSEN = 0;
+
+	CTMUCONLbits.EDG1STAT = 1;					// start charging
+	for(i = 0; i < ADC_TOUCH_CHARGE_LOOPS; i++)
+		;
+	CTMUCONLbits.EDG1STAT = 0;					// stop charging
+
+	ADCON0bits.GO = 1;
+}
+
+/*********************************************************************
+* Function:  void AdcSched_Init(void)
+*
+* PreCondition: mTouchInit() has configured the CTMU current source
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: takes ownership of ADCON0/ADCON1, Timer1 and ECCP2,
+*				enables the A/D interrupt and global interrupts
+*
+* Overview: configures the converter and starts the slot schedule
+*
+********************************************************************/
+void AdcSched_Init(void)
+{
+	BYTE i;
+
+	PIE1bits.ADIE = 0;
+
+	ANCON0 &= 0b11100000;						// AN0..AN4 analog
+
+	ADCON1 = 0b10111110;						// right justified, 20 TAD acquisition, Fosc/64
+	ADCON0 = 0b00000001;						// Vdd/Vss reference, converter on
+	ADCON0bits.CHS = ADC_POT_CHANNEL;
+
+	slot = ADC_SLOT_POT;
+	potCount = 0;
+	potAccum = 0;
+	potValue = 0;
+	potSequence = 0;
+	for(i = 0; i < ADC_TOUCH_CHANNELS; i++)
+		touchValue[i] = 0xFFFF;					// untouched until the first pass
+	touchReady = FALSE;
+
+	T1CON = 0b00110010;							// Fosc/4, 1:8, 16 bit reads, off
+	TMR1H = 0;
+	TMR1L = 0;
+	CCPR2H = (BYTE)(ADC_TRIGGER_PERIOD >> 8);
+	CCPR2L = (BYTE)ADC_TRIGGER_PERIOD;
+	CCP2CON = CCP2_SPECIAL_EVENT;
+
+	PIR1bits.ADIF = 0;
+	PIE1bits.ADIE = 1;
+	RCONbits.IPEN = 0;
+	INTCONbits.PEIE = 1;
+	INTCONbits.GIE = 1;
+
+	T1CONbits.TMR1ON = 1;
+}
+
+/*********************************************************************
+* Function:  void AdcSched_ISR(void)
+*
+* PreCondition: PIR1bits.ADIF is set
+*
+* Overview: stores the finished conversion and arms the next slot
+*
+********************************************************************/
+void AdcSched_ISR(void)
+{
+	PIR1bits.ADIF = 0;
+
+	if(slot == ADC_SLOT_POT)
+	{
+		potAccum += ADRES;
+		if(++potCount < ADC_POT_OVERSAMPLE)
+			return;								// next one is hardware triggered
+
+		potValue = potAccum >> ADC_POT_DECIMATE_SHIFT;
+		potSequence++;
+		potAccum = 0;
+		potCount = 0;
+
+		CCP2CON = CCP2_OFF;						// pads are triggered by hand
+		slot = 1;
+	}
+	else
+	{
+		touchValue[slot - 1] = ADRES;
+
+		if(++slot > ADC_TOUCH_CHANNELS)
+		{
+			touchReady = TRUE;
+			slot = ADC_SLOT_POT;
+			ADCON0bits.CHS = ADC_POT_CHANNEL;
+			TMR1H = 0;
+			TMR1L = 0;
+			CCP2CON = CCP2_SPECIAL_EVENT;
+			return;
+		}
+	}
+
+	AdcSched_StartTouch(slot - 1);
+}
+
+/*********************************************************************
+* Function:  void AdcSched_Suspend(void)
+*
+* Overview: stops the schedule before Sleep(). The converter clock
+*			stops in sleep, so a conversion left running would never
+*			raise ADIF and the schedule would stall.
+*
+********************************************************************/
+void AdcSched_Suspend(void)
+{
+	PIE1bits.ADIE = 0;
+	CCP2CON = CCP2_OFF;
+	T1CONbits.TMR1ON = 0;
+	while(ADCON0bits.GO)
+		;
+	PIR1bits.ADIF = 0;
+}
+
+/*********************************************************************
+* Function:  void AdcSched_Resume(void)
+*
+* Overview: restarts the schedule at the first pot slot. The last
+*			published values stay valid until they are refreshed.
+*
+********************************************************************/
+void AdcSched_Resume(void)
+{
+	slot = ADC_SLOT_POT;
+	potCount = 0;
+	potAccum = 0;
+
+	ADCON0bits.CHS = ADC_POT_CHANNEL;
+	TMR1H = 0;
+	TMR1L = 0;
+	CCP2CON = CCP2_SPECIAL_EVENT;
+
+	PIR1bits.ADIF = 0;
+	PIE1bits.ADIE = 1;
+	T1CONbits.TMR1ON = 1;
+}
+
+/*********************************************************************
+* Function:  WORD AdcSched_Pot(void)
+*
+* Output: latest decimated potentiometer value, 0..ADC_POT_FULL_SCALE
+*
+********************************************************************/
+WORD AdcSched_Pot(void)
+{
+	WORD value;
+	BYTE enabled;
+
+	enabled = PIE1bits.ADIE;			// off while suspended
+	PIE1bits.ADIE = 0;
+	value = potValue;
+	PIE1bits.ADIE = enabled;
+
+	return value;
+}
+
+/*********************************************************************
+* Function:  BYTE AdcSched_PotSequence(void)
+*
+* Output: counter bumped every time a new pot value is published
+*
+********************************************************************/
+BYTE AdcSched_PotSequence(void)
+{
+	return potSequence;
+}
+
+/*********************************************************************
+* Function:  BOOL AdcSched_TouchReady(void)
+*
+* Output: TRUE once every pad has been converted at least once
+*
+********************************************************************/
+BOOL AdcSched_TouchReady(void)
+{
+	return touchReady;
+}
+
+/*********************************************************************
+* Function:  WORD AdcSched_Touch(BYTE channel)
+*
+* Input: channel - pad number, same numbering as mTouchReadButton()
+*
+* Output: latest raw reading of the pad (lower when touched)
+*
+********************************************************************/
+WORD AdcSched_Touch(BYTE channel)
+{
+	WORD value;
+	BYTE enabled;
+
+	enabled = PIE1bits.ADIE;			// off while suspended
+	PIE1bits.ADIE = 0;
+	value = touchValue[channel];
+	PIE1bits.ADIE = enabled;
+
+	return value;
+}
@@ -0,0 +1,54 @@
+/********************************************************************
+  File Information:
+    FileName:     	adc_sched.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    A/D converter scheduler. Owns the converter and interleaves the
+    potentiometer and the mTouch pads from the A/D interrupt, so the
+    UI never waits on ADCON0bits.GO.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef ADC_SCHED_H
+#define ADC_SCHED_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+/*********************************************/
+
+// Analog channel of the potentiometer (AN4)
+#define ADC_POT_CHANNEL			4
+
+// Number of mTouch pads, read on AN0..AN3 in mTouchReadButton() order
+#define ADC_TOUCH_CHANNELS		4
+
+// Pot conversions accumulated per published result. 16 x 10 bit
+// samples decimated by 4 give 12 effective bits.
+#define ADC_POT_OVERSAMPLE		16
+#define ADC_POT_DECIMATE_SHIFT	2
+#define ADC_POT_FULL_SCALE		4095
+
+// Rate of the hardware triggered pot conversions (ECCP2 special event)
+#define ADC_TRIGGER_HZ			4000
+
+// Busy-wait iterations the CTMU current source charges a touch pad for
+#define ADC_TOUCH_CHARGE_LOOPS	4
+
+void AdcSched_Init(void);
+void AdcSched_ISR(void);
+void AdcSched_Suspend(void);
+void AdcSched_Resume(void);
+
+WORD AdcSched_Pot(void);
+WORD AdcSched_Touch(BYTE channel);
+BYTE AdcSched_PotSequence(void);
+BOOL AdcSched_TouchReady(void);
+
+#endif
@@ -0,0 +1,345 @@
+/********************************************************************
+  File Information:
+    FileName:     	gesture.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Accelerometer gesture recogniser, see gesture.h
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "gesture.h"
+#include "quantiser.h"
+/*********************************************/
+
+// The filter state keeps GESTURE_FRAC_BITS below the raw LSB
+#define GESTURE_FRAC_BITS		4
+
+#define TILT_ENTER				ACCEL_MG_TO_RAW(GESTURE_TILT_ENTER_MG)
+#define TILT_EXIT				ACCEL_MG_TO_RAW(GESTURE_TILT_EXIT_MG)
+#define FLIP_Z					ACCEL_MG_TO_RAW(GESTURE_FLIP_MG)
+#define UPRIGHT_Z				ACCEL_MG_TO_RAW(GESTURE_UPRIGHT_MG)
+#define SHAKE_SWING				ACCEL_MG_TO_RAW(GESTURE_SHAKE_MG)
+#define BAND_SPAN				ACCEL_MG_TO_RAW(GESTURE_BAND_SPAN_MG)
+
+#define SHAKE_NONE				0
+#define SHAKE_POSITIVE			1
+#define SHAKE_NEGATIVE			2
+
+typedef struct
+{
+	NAV_EVENT dir;							// NAV_NONE while inside the dead zone
+	BYTE timer;								// samples left until the next repeat
+} GESTURE_TILT;
+
+static BYTE decimateCount;
+static SHORT sumX, sumY, sumZ;
+
+static BOOL primed;
+static SHORT lpfX, lpfY, lpfZ;				// raw << GESTURE_FRAC_BITS
+
+static GESTURE_TILT tiltX, tiltY;
+
+static BOOL flipArmed;
+static BYTE flipCount;
+
+static BYTE shakeSign;
+static BYTE shakePeaks;
+static BYTE shakeTimer;
+static BYTE shakeHoldoff;
+
+static QUANTISER tiltBands;
+
+
+/*********************************************************************
+* Function:  static NAV_EVENT Gesture_Tilt(GESTURE_TILT *t, SHORT value,
+*										   NAV_EVENT positive,
+*										   NAV_EVENT negative)
+*
+* Overview: dead zone and auto-repeat for one filtered axis
+*
+********************************************************************/
+static NAV_EVENT Gesture_Tilt(GESTURE_TILT *t, SHORT value, NAV_EVENT positive, NAV_EVENT negative)
+{
+	if(t->dir == NAV_NONE)
+	{
+		if(value > TILT_ENTER)
+			t->dir = positive;
+		else if(value < -TILT_ENTER)
+			t->dir = negative;
+		else
+			return NAV_NONE;
+
+		t->timer = GESTURE_REPEAT_DELAY;
+		return t->dir;
+	}
+
+	if((t->dir == positive && value < TILT_EXIT) ||
+	   (t->dir == negative && value > -TILT_EXIT))
+	{
+		t->dir = NAV_NONE;
+		return NAV_NONE;
+	}
+
+	if(--t->timer)
+		return NAV_NONE;
+
+	t->timer = GESTURE_REPEAT_PERIOD;
+	return t->dir;
+}
+
+/*********************************************************************
+* Function:  static BOOL Gesture_Shake(SHORT swing)
+*
+* Input: swing - unfiltered X minus filtered X
+*
+* Output: TRUE when the last swing completed a shake
+*
+********************************************************************/
+static BOOL Gesture_Shake(SHORT swing)
+{
+	BYTE sign;
+
+	if(shakeTimer && --shakeTimer == 0)
+	{
+		shakePeaks = 0;
+		shakeSign = SHAKE_NONE;
+	}
+
+	if(swing > SHAKE_SWING)
+		sign = SHAKE_POSITIVE;
+	else if(swing < -SHAKE_SWING)
+		sign = SHAKE_NEGATIVE;
+	else
+		return FALSE;
+
+	if(sign == shakeSign)
+		return FALSE;								// same swing, still going
+	shakeSign = sign;
+
+	if(shakePeaks++ == 0)
+		shakeTimer = GESTURE_SHAKE_WINDOW;
+
+	if(shakePeaks < GESTURE_SHAKE_PEAKS)
+		return FALSE;
+
+	shakePeaks = 0;
+	shakeTimer = 0;
+	shakeSign = SHAKE_NONE;
+	return TRUE;
+}
+
+/*********************************************************************
+* Function:  static NAV_EVENT Gesture_Update(SHORT x, SHORT y, SHORT z)
+*
+* Input: x, y, z - one decimated sample in raw counts
+*
+* Output: the event recognised on this sample, if any. Shake beats
+*		  flip, flip beats tilt.
+*
+********************************************************************/
+static NAV_EVENT Gesture_Update(SHORT x, SHORT y, SHORT z)
+{
+	NAV_EVENT event;
+	NAV_EVENT tilt;
+	SHORT fx, fy, fz;
+
+	if(!primed)
+	{
+		lpfX = x << GESTURE_FRAC_BITS;
+		lpfY = y << GESTURE_FRAC_BITS;
+		lpfZ = z << GESTURE_FRAC_BITS;
+		primed = TRUE;
+	}
+	else
+	{
+		lpfX += ((x << GESTURE_FRAC_BITS) - lpfX) >> GESTURE_LPF_SHIFT;
+		lpfY += ((y << GESTURE_FRAC_BITS) - lpfY) >> GESTURE_LPF_SHIFT;
+		lpfZ += ((z << GESTURE_FRAC_BITS) - lpfZ) >> GESTURE_LPF_SHIFT;
+	}
+
+	fx = lpfX >> GESTURE_FRAC_BITS;
+	fy = lpfY >> GESTURE_FRAC_BITS;
+	fz = lpfZ >> GESTURE_FRAC_BITS;
+
+	event = NAV_NONE;
+
+	if(Gesture_Shake(x - fx))
+	{
+		event = NAV_HOME;
+		shakeHoldoff = GESTURE_SHAKE_HOLDOFF;
+		tiltX.dir = NAV_NONE;
+		tiltY.dir = NAV_NONE;
+	}
+
+	if(fz < FLIP_Z)
+	{
+		if(flipArmed && ++flipCount >= GESTURE_FLIP_SAMPLES)
+		{
+			flipArmed = FALSE;
+			if(event == NAV_NONE)
+				event = NAV_BACK;
+		}
+	}
+	else
+	{
+		flipCount = 0;
+		if(fz > UPRIGHT_Z)
+			flipArmed = TRUE;
+	}
+
+	if(shakeHoldoff)
+	{
+		shakeHoldoff--;
+		return event;
+	}
+
+	tilt = Gesture_Tilt(&tiltY, fy, NAV_UP, NAV_DOWN);
+	if(event == NAV_NONE)
+		event = tilt;
+	tilt = Gesture_Tilt(&tiltX, fx, NAV_RIGHT, NAV_LEFT);
+	if(event == NAV_NONE)
+		event = tilt;
+
+	return event;
+}
+
+/*********************************************************************
+* Function:  void Gesture_Init(void)
+*
+* PreCondition: Accel_InitInterrupts() has been called
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: forgets any gesture in progress; the filter restarts
+*			from the next sample
+*
+********************************************************************/
+void Gesture_Init(void)
+{
+	decimateCount = 0;
+	sumX = sumY = sumZ = 0;
+	primed = FALSE;
+
+	tiltX.dir = NAV_NONE;
+	tiltY.dir = NAV_NONE;
+
+	flipArmed = TRUE;
+	flipCount = 0;
+
+	shakeSign = SHAKE_NONE;
+	shakePeaks = 0;
+	shakeTimer = 0;
+	shakeHoldoff = 0;
+
+	Gesture_SetTiltBands(1);
+}
+
+/*********************************************************************
+* Function:  NAV_EVENT Gesture_Feed(BMA150_XYZ *xyz)
+*
+* PreCondition: Gesture_Init() has been called
+*
+* Input: xyz - one new accelerometer sample
+*
+* Output: navigation event, NAV_NONE most of the time
+*
+* Side Effects: none
+*
+* Overview: runs the recogniser on a sample from any source, the
+*			BMA150 itself or a recorded session
+*
+********************************************************************/
+NAV_EVENT Gesture_Feed(BMA150_XYZ *xyz)
+{
+	SHORT x, y, z;
+
+	sumX += xyz->x;
+	sumY += xyz->y;
+	sumZ += xyz->z;
+	if(++decimateCount < GESTURE_DECIMATE)
+		return NAV_NONE;
+
+	x = sumX / GESTURE_DECIMATE;
+	y = sumY / GESTURE_DECIMATE;
+	z = sumZ / GESTURE_DECIMATE;
+	sumX = sumY = sumZ = 0;
+	decimateCount = 0;
+
+	return Gesture_Update(x, y, z);
+}
+
+/*********************************************************************
+* Function:  NAV_EVENT Gesture_Poll(void)
+*
+* PreCondition: Gesture_Init() has been called
+*
+* Input: none
+*
+* Output: navigation event, NAV_NONE most of the time
+*
+* Side Effects: none
+*
+* Overview: consumes a new BMA150 sample if there is one. Cheap to
+*			call on every pass of a UI loop.
+*
+********************************************************************/
+NAV_EVENT Gesture_Poll(void)
+{
+	BMA150_XYZ xyz;
+
+	if(!BMA150_ReadFresh(&xyz))
+		return NAV_NONE;
+
+	return Gesture_Feed(&xyz);
+}
+
+/*********************************************************************
+* Function:  void Gesture_SetTiltBands(BYTE items)
+*
+* Input: items - number of bands, 1..QUANT_MAX_ITEMS
+*
+* Overview: spreads 0..GESTURE_BAND_SPAN_MG of X tilt over items
+*			bands for Gesture_TiltBand()
+*
+********************************************************************/
+void Gesture_SetTiltBands(BYTE items)
+{
+	Quantiser_Init(&tiltBands, items, BAND_SPAN, GESTURE_BAND_HYSTERESIS);
+}
+
+/*********************************************************************
+* Function:  BYTE Gesture_TiltBand(void)
+*
+* PreCondition: Gesture_Poll() or Gesture_Feed() is being called
+*
+* Output: band 0..items-1 selected by the filtered X tilt. Tilts
+*		  below 0 select the first band, beyond the span the last.
+*
+********************************************************************/
+BYTE Gesture_TiltBand(void)
+{
+	SHORT fx;
+
+	fx = lpfX >> GESTURE_FRAC_BITS;
+	if(fx < 0)
+		fx = 0;
+	if(fx > BAND_SPAN)
+		fx = BAND_SPAN;
+
+	return Quantiser_Update(&tiltBands, (WORD)fx);
+}
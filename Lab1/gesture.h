@@ -0,0 +1,77 @@
+/********************************************************************
+  File Information:
+    FileName:     	gesture.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Accelerometer gesture recogniser. Fresh BMA150 samples are
+    decimated, low-pass filtered and turned into navigation events:
+
+      tilt forward / back      NAV_UP / NAV_DOWN, with auto-repeat
+      tilt left / right        NAV_LEFT / NAV_RIGHT, with auto-repeat
+      flip over                NAV_BACK
+      shake                    NAV_HOME
+
+    Each tilt has a dead zone: it must pass GESTURE_TILT_ENTER_MG to
+    fire and come back inside GESTURE_TILT_EXIT_MG to re-arm. The
+    filtered X axis can also select one of N bands directly, for the
+    screens that pick an item by holding the board at an angle.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef GESTURE_H
+#define GESTURE_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "accel.h"
+#include "nav.h"
+/*********************************************/
+
+// New BMA150 samples averaged into one gesture sample (50 Hz -> 25 Hz);
+// Accel_InitInterrupts() sets the bandwidth that gives the 50 Hz
+#define GESTURE_DECIMATE		2
+
+// Low-pass filter: y += (x - y) >> GESTURE_LPF_SHIFT per gesture sample
+#define GESTURE_LPF_SHIFT		2
+
+// Tilt dead zone, forward/back on Y and left/right on X
+#define GESTURE_TILT_ENTER_MG	350
+#define GESTURE_TILT_EXIT_MG	200
+
+// Auto-repeat while a tilt is held, in gesture samples (40 ms each)
+#define GESTURE_REPEAT_DELAY	15
+#define GESTURE_REPEAT_PERIOD	6
+
+// Z below this for GESTURE_FLIP_SAMPLES means the board is face down;
+// it must come back above GESTURE_UPRIGHT_MG before it can fire again
+#define GESTURE_FLIP_MG			(-227)
+#define GESTURE_UPRIGHT_MG		200
+#define GESTURE_FLIP_SAMPLES	3
+
+// Shake: GESTURE_SHAKE_PEAKS alternating X swings away from the
+// filtered value, each larger than GESTURE_SHAKE_MG, within
+// GESTURE_SHAKE_WINDOW samples. Tilts are ignored for
+// GESTURE_SHAKE_HOLDOFF samples afterwards.
+#define GESTURE_SHAKE_MG		700
+#define GESTURE_SHAKE_PEAKS		4
+#define GESTURE_SHAKE_WINDOW	15
+#define GESTURE_SHAKE_HOLDOFF	12
+
+// Tilt range spread over the bands of Gesture_SetTiltBands()
+#define GESTURE_BAND_SPAN_MG	200
+#define GESTURE_BAND_HYSTERESIS	2
+
+void Gesture_Init(void);
+NAV_EVENT Gesture_Feed(BMA150_XYZ *xyz);
+NAV_EVENT Gesture_Poll(void);
+void Gesture_SetTiltBands(BYTE items);
+BYTE Gesture_TiltBand(void);
+
+#endif
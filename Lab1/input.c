@@ -0,0 +1,245 @@
+/********************************************************************
+  File Information:
+    FileName:     	input.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    User input layer, see input.h
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "input.h"
+#include "adc_sched.h"
+#include "quantiser.h"
+#include "gesture.h"
+#include "inputlog.h"
+/*********************************************/
+
+// Pads in mTouchReadButton() order
+#define PAD_RIGHT				0
+#define PAD_UP					1
+#define PAD_DOWN				2
+#define PAD_LEFT				3
+
+static WORD touchLevel[ADC_TOUCH_CHANNELS];
+static BYTE buttonCount;
+static BOOL buttonHeld;
+static BOOL buttonEvent;
+static NAV_EVENT gestureEvent;
+static QUANTISER potMenu;
+
+
+/*********************************************************************
+* Function:  void Input_Init(void)
+*
+* PreCondition: AdcSched_Init() and Gesture_Init() have been called
+*
+* Overview: starts with no pending events, every pad idle and a 1
+*			item pot menu
+*
+********************************************************************/
+void Input_Init(void)
+{
+	BYTE i;
+
+	for(i = 0; i < ADC_TOUCH_CHANNELS; i++)
+		touchLevel[i] = 0xFFFF;					// untouched
+	touchLevel[PAD_DOWN] = SCROLL_DOWN_IDLE;	// the scroll pair reads high when touched
+	touchLevel[PAD_UP] = SCROLL_UP_LEVEL;
+	buttonCount = 0;
+	buttonHeld = FALSE;
+	buttonEvent = FALSE;
+	gestureEvent = NAV_NONE;
+
+	Input_SetPotItems(1);
+}
+
+/*********************************************************************
+* Function:  void Input_TouchTask(void)
+*
+* Overview: 100 Hz. Latches the touch pad levels and debounces the
+*			push button: a press is reported on release, once it has
+*			been held for BUTTON_DEBOUNCE_TICKS samples.
+*
+********************************************************************/
+void Input_TouchTask(void)
+{
+	BYTE i;
+
+	InputLog_Service();
+
+	if(AdcSched_TouchReady())					// idle levels until the first pad pass
+	{
+		for(i = 0; i < ADC_TOUCH_CHANNELS; i++)
+			touchLevel[i] = Input_ReadTouch(i);
+	}
+
+	if(Input_ReadButton() == 0)
+	{
+		if(buttonCount < BUTTON_DEBOUNCE_TICKS)
+			buttonCount++;
+		else
+			buttonHeld = TRUE;
+	}
+	else
+	{
+		if(buttonHeld)
+		{
+			buttonEvent = TRUE;
+			InputLog_Event(NAV_SELECT);
+		}
+		buttonHeld = FALSE;
+		buttonCount = 0;
+	}
+}
+
+/*********************************************************************
+* Function:  void Input_PotTask(void)
+*
+* Overview: 50 Hz. Moves the pot selection; the first item sits at
+*			the top of the pot travel.
+*
+********************************************************************/
+void Input_PotTask(void)
+{
+	Quantiser_Update(&potMenu, ADC_POT_FULL_SCALE - Input_ReadPot());
+}
+
+/*********************************************************************
+* Function:  void Input_AccelTask(void)
+*
+* Overview: 50 Hz. Runs the gesture recogniser and keeps the last
+*			event until the UI takes it.
+*
+********************************************************************/
+void Input_AccelTask(void)
+{
+	BMA150_XYZ xyz;
+	NAV_EVENT event;
+
+	if(!Input_ReadAccel(&xyz))
+		return;
+
+	event = Gesture_Feed(&xyz);
+	if(event != NAV_NONE)
+	{
+		gestureEvent = event;
+		InputLog_Event(event);
+	}
+}
+
+/*********************************************************************
+* Function:  BOOL Input_ButtonPressed(void)
+*
+* Output: TRUE once per press of the push button
+*
+********************************************************************/
+BOOL Input_ButtonPressed(void)
+{
+	if(buttonEvent)
+	{
+		buttonEvent = FALSE;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/*********************************************************************
+* Function:  NAV_EVENT Input_TakeEvent(void)
+*
+* Output: NAV_SELECT for a button press, otherwise the last gesture
+*		  (see Input_TakeGesture()), or NAV_NONE
+*
+* Overview: the frame's navigation event; the pads are levels and
+*			are read by the screens themselves
+*
+********************************************************************/
+NAV_EVENT Input_TakeEvent(void)
+{
+	if(Input_ButtonPressed())
+		return NAV_SELECT;
+
+	return Input_TakeGesture();
+}
+
+/*********************************************************************
+* Function:  NAV_EVENT Input_ScrollPad(void)
+*
+* Output: NAV_UP or NAV_DOWN while the scroll pair is touched,
+*		  NAV_NONE otherwise
+*
+********************************************************************/
+NAV_EVENT Input_ScrollPad(void)
+{
+	if(touchLevel[PAD_DOWN] > SCROLL_DOWN_LEVEL)
+		return NAV_DOWN;
+	if(touchLevel[PAD_DOWN] >= SCROLL_DOWN_IDLE && touchLevel[PAD_UP] > SCROLL_UP_LEVEL)
+		return NAV_UP;
+
+	return NAV_NONE;
+}
+
+/*********************************************************************
+* Function:  BOOL Input_LeftPad(void), BOOL Input_RightPad(void)
+*
+* Output: TRUE while the pad is touched
+*
+********************************************************************/
+BOOL Input_LeftPad(void)
+{
+	return touchLevel[PAD_LEFT] <= SIDE_PRESSED_LEVEL;
+}
+
+BOOL Input_RightPad(void)
+{
+	return touchLevel[PAD_RIGHT] <= SIDE_PRESSED_LEVEL;
+}
+
+/*********************************************************************
+* Function:  NAV_EVENT Input_TakeGesture(void)
+*
+* Output: last gesture since the previous call, or NAV_NONE
+*
+********************************************************************/
+NAV_EVENT Input_TakeGesture(void)
+{
+	NAV_EVENT event;
+
+	event = gestureEvent;
+	gestureEvent = NAV_NONE;
+	return event;
+}
+
+/*********************************************************************
+* Function:  void Input_SetPotItems(BYTE items)
+*
+* Input: items - number of items the pot travel is split into
+*
+********************************************************************/
+void Input_SetPotItems(BYTE items)
+{
+	Quantiser_Init(&potMenu, items, ADC_POT_FULL_SCALE, POT_HYSTERESIS);
+	Input_PotTask();
+}
+
+/*********************************************************************
+* Function:  BYTE Input_PotItem(void)
+*
+* Output: item selected by the pot, 0..items-1
+*
+********************************************************************/
+BYTE Input_PotItem(void)
+{
+	return Quantiser_Index(&potMenu);
+}
@@ -0,0 +1,58 @@
+/********************************************************************
+  File Information:
+    FileName:     	input.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    User input layer of the menu app. The three tasks sample the
+    touch pads, the push button, the pot and the accelerometer at
+    fixed rates (they go in the scheduler table); the UI reads the
+    latched results through the calls below.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef INPUT_H
+#define INPUT_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "nav.h"
+/*********************************************/
+
+// Pot travel the hand has to move past a band edge before the item changes
+#define POT_HYSTERESIS			48
+
+// Touch task samples the push button must read pressed to count
+#define BUTTON_DEBOUNCE_TICKS	3
+
+// Pad levels. The scroll pair reads down above SCROLL_DOWN_LEVEL,
+// up above SCROLL_UP_LEVEL while down sits at or above SCROLL_DOWN_IDLE;
+// a side pad is pressed below SIDE_PRESSED_LEVEL.
+#define SCROLL_DOWN_LEVEL		980
+#define SCROLL_DOWN_IDLE		975
+#define SCROLL_UP_LEVEL			965
+#define SIDE_PRESSED_LEVEL		800
+
+void Input_Init(void);
+
+void Input_TouchTask(void);
+void Input_PotTask(void);
+void Input_AccelTask(void);
+
+NAV_EVENT Input_TakeEvent(void);
+BOOL Input_ButtonPressed(void);
+NAV_EVENT Input_ScrollPad(void);
+BOOL Input_LeftPad(void);
+BOOL Input_RightPad(void);
+NAV_EVENT Input_TakeGesture(void);
+
+void Input_SetPotItems(BYTE items);
+BYTE Input_PotItem(void);
+
+#endif
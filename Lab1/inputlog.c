@@ -0,0 +1,430 @@
+/********************************************************************
+  File Information:
+    FileName:     	inputlog.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Input recorder and replay source, see inputlog.h
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "inputlog.h"
+#include "sched.h"
+#include <stdlib.h>
+/*********************************************/
+
+#if INPUTLOG_MODE != INPUTLOG_OFF
+
+// BRG16 = 1, BRGH = 1: SPBRG = Fosc / (4 * baud) - 1
+#define INPUTLOG_SPBRG			((WORD)(48000000UL / (4UL * INPUTLOG_BAUD) - 1))
+#define PPS_TX2					5
+
+static WORD startTick;
+static WORD navCount;
+
+static void InputLog_Reset(void);
+
+
+/*********************************************************************
+* Function:  static void InputLog_Putc(char c)
+*
+* Overview: blocking write of one character to UART2
+*
+********************************************************************/
+static void InputLog_Putc(char c)
+{
+	while(!PIR3bits.TX2IF);
+	TXREG2 = c;
+}
+
+static void InputLog_PutROMString(const rom char *str)
+{
+	while(*str)
+		InputLog_Putc(*str++);
+}
+
+static void InputLog_PutNumber(SHORT value)
+{
+	char str[8];
+	char *p;
+
+	itoa(value, str);
+	for(p = str; *p; p++)
+		InputLog_Putc(*p);
+}
+
+/*********************************************************************
+* Function:  void InputLog_Init(void)
+*
+* PreCondition: Sched_Init() has been called
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: maps TX2 to INPUTLOG_TX_RPOR and enables UART2
+*
+* Overview: starts recording, or starts the replay clock
+*
+********************************************************************/
+void InputLog_Init(void)
+{
+	BYTE gie;
+
+	INPUTLOG_TX_TRIS = 0;
+
+	gie = INTCONbits.GIE;
+	INTCONbits.GIE = 0;
+	EECON2 = 0x55;								// PPS unlock sequence
+	EECON2 = 0xAA;
+	PPSCONbits.IOLOCK = 0;
+	INPUTLOG_TX_RPOR = PPS_TX2;
+	EECON2 = 0x55;
+	EECON2 = 0xAA;
+	PPSCONbits.IOLOCK = 1;
+	INTCONbits.GIE = gie;
+
+	BAUDCON2bits.BRG16 = 1;
+	SPBRGH2 = (BYTE)(INPUTLOG_SPBRG >> 8);
+	SPBRG2 = (BYTE)INPUTLOG_SPBRG;
+	TXSTA2 = 0b00100100;						// 8 bit, transmit enabled, BRGH
+	RCSTA2bits.SPEN = 1;
+
+	startTick = Sched_Ticks();
+	navCount = 0;
+	InputLog_Reset();
+}
+
+#endif
+
+#if INPUTLOG_MODE == INPUTLOG_RECORD
+
+#pragma udata INPUT_LOG
+static INPUT_RECORD ring[INPUTLOG_RECORDS];
+#pragma udata
+
+static BYTE head;								// next slot to write
+static BYTE used;
+
+static WORD lastTouch[ADC_TOUCH_CHANNELS];
+static BYTE lastButton;
+static WORD lastPot;
+static BMA150_XYZ lastAccel;
+
+/*********************************************************************
+* Function:  static void InputLog_Append(BYTE source, BYTE arg,
+*										 SHORT v0, SHORT v1, SHORT v2)
+*
+* Overview: stores one record, overwriting the oldest when full
+*
+********************************************************************/
+static void InputLog_Append(BYTE source, BYTE arg, SHORT v0, SHORT v1, SHORT v2)
+{
+	INPUT_RECORD *r;
+
+	r = &ring[head];
+	r->tick = Sched_Ticks() - startTick;
+	r->source = source;
+	r->arg = arg;
+	r->v[0] = v0;
+	r->v[1] = v1;
+	r->v[2] = v2;
+
+	if(++head >= INPUTLOG_RECORDS)
+		head = 0;
+	if(used < INPUTLOG_RECORDS)
+		used++;
+}
+
+static BOOL InputLog_Moved(WORD a, WORD b, WORD delta)
+{
+	return (a > b ? a - b : b - a) >= delta;
+}
+
+static BOOL InputLog_MovedSigned(SHORT a, SHORT b, SHORT delta)
+{
+	return abs((SHORT)(a - b)) >= delta;	//signed: -1 to 0 is one count
+}
+
+/*********************************************************************
+* Function:  static void InputLog_Reset(void)
+*
+* Overview: empties the ring. The first reading of every source is
+*			always recorded, so a dump starts from a known state.
+*
+********************************************************************/
+static void InputLog_Reset(void)
+{
+	BYTE i;
+
+	head = 0;
+	used = 0;
+
+	for(i = 0; i < ADC_TOUCH_CHANNELS; i++)
+		lastTouch[i] = 0x8000;
+	lastButton = 0xFF;
+	lastPot = 0x8000;
+	lastAccel.x = lastAccel.y = lastAccel.z = 0x4000;
+}
+
+void InputLog_Service(void)
+{
+	// nothing to do while recording, the Input_Read*() calls log
+}
+
+WORD Input_ReadTouch(BYTE pad)
+{
+	WORD value;
+
+	value = AdcSched_Touch(pad);
+	if(InputLog_Moved(value, lastTouch[pad], INPUTLOG_TOUCH_DELTA))
+	{
+		InputLog_Append(INPUT_SRC_TOUCH, pad, value, 0, 0);
+		lastTouch[pad] = value;
+	}
+	return value;
+}
+
+BYTE Input_ReadButton(void)
+{
+	BYTE level;
+
+	level = PORTBbits.RB0;
+	if(level != lastButton)
+	{
+		InputLog_Append(INPUT_SRC_BUTTON, 0, level, 0, 0);
+		lastButton = level;
+	}
+	return level;
+}
+
+WORD Input_ReadPot(void)
+{
+	WORD value;
+
+	value = AdcSched_Pot();
+	if(InputLog_Moved(value, lastPot, INPUTLOG_POT_DELTA))
+	{
+		InputLog_Append(INPUT_SRC_POT, 0, value, 0, 0);
+		lastPot = value;
+	}
+	return value;
+}
+
+BOOL Input_ReadAccel(BMA150_XYZ *xyz)
+{
+	if(!BMA150_ReadFresh(xyz))
+		return FALSE;
+
+	if(InputLog_MovedSigned(xyz->x, lastAccel.x, INPUTLOG_ACCEL_DELTA) ||
+	   InputLog_MovedSigned(xyz->y, lastAccel.y, INPUTLOG_ACCEL_DELTA) ||
+	   InputLog_MovedSigned(xyz->z, lastAccel.z, INPUTLOG_ACCEL_DELTA))
+	{
+		InputLog_Append(INPUT_SRC_ACCEL, 0, xyz->x, xyz->y, xyz->z);
+		lastAccel = *xyz;
+	}
+	return TRUE;
+}
+
+void InputLog_Event(NAV_EVENT event)
+{
+	InputLog_Append(INPUT_SRC_NAV, (BYTE)event, 0, 0, 0);
+	navCount++;
+}
+
+/*********************************************************************
+* Function:  void InputLog_Dump(void)
+*
+* PreCondition: InputLog_Init() has been called
+*
+* Overview: prints the ring, oldest record first, as rows for
+*			inputlog_session.h. Ticks are made relative to the oldest
+*			record; the closing INPUT_SRC_END row carries the time of
+*			the dump. Blocks for the length of the transmission.
+*
+********************************************************************/
+void InputLog_Dump(void)
+{
+	BYTE i, n;
+	WORD first;
+	INPUT_RECORD *r;
+
+	i = (used < INPUTLOG_RECORDS) ? 0 : head;
+	first = ring[i].tick;
+
+	InputLog_PutROMString("// tick, source, arg, { v0, v1, v2 }\r\n");
+	for(n = 0; n < used; n++)
+	{
+		r = &ring[i];
+
+		InputLog_PutROMString("\t{ ");
+		InputLog_PutNumber(r->tick - first);
+		InputLog_PutROMString(", ");
+		InputLog_PutNumber(r->source);
+		InputLog_PutROMString(", ");
+		InputLog_PutNumber(r->arg);
+		InputLog_PutROMString(", { ");
+		InputLog_PutNumber(r->v[0]);
+		InputLog_PutROMString(", ");
+		InputLog_PutNumber(r->v[1]);
+		InputLog_PutROMString(", ");
+		InputLog_PutNumber(r->v[2]);
+		InputLog_PutROMString(" } },\r\n");
+
+		if(++i >= INPUTLOG_RECORDS)
+			i = 0;
+	}
+	InputLog_PutROMString("\t{ ");
+	InputLog_PutNumber(Sched_Ticks() - startTick - first);
+	InputLog_PutROMString(", INPUT_SRC_END }\r\n");
+}
+
+#elif INPUTLOG_MODE == INPUTLOG_REPLAY
+
+static rom INPUT_RECORD session[] =
+{
+#include "inputlog_session.h"
+};
+
+static WORD cursor;
+static BOOL finished;
+
+static WORD touch[ADC_TOUCH_CHANNELS];
+static BYTE button;
+static WORD pot;
+static BMA150_XYZ accel;
+
+static void InputLog_Reset(void)
+{
+	cursor = 0;
+	finished = FALSE;
+	button = 1;									// released
+}
+
+/*********************************************************************
+* Function:  static void InputLog_Summary(WORD elapsed)
+*
+* Overview: prints the figures to compare between firmware builds
+*
+********************************************************************/
+static void InputLog_Summary(WORD elapsed)
+{
+	BYTE i;
+	WORD overruns;
+
+	overruns = 0;
+	for(i = 0; i < SCHED_MAX_TASKS; i++)
+		overruns += Sched_TaskOverruns(i);
+
+	InputLog_PutROMString("replay done: ms=");
+	InputLog_PutNumber(elapsed);
+	InputLog_PutROMString(" frames=");
+	InputLog_PutNumber(Sched_FrameCount());
+	InputLog_PutROMString(" frame_overruns=");
+	InputLog_PutNumber(Sched_FrameOverruns());
+	InputLog_PutROMString(" task_overruns=");
+	InputLog_PutNumber(overruns);
+	InputLog_PutROMString(" nav_events=");
+	InputLog_PutNumber(navCount);
+	InputLog_PutROMString("\r\n");
+}
+
+/*********************************************************************
+* Function:  void InputLog_Service(void)
+*
+* PreCondition: InputLog_Init() has been called
+*
+* Overview: applies every session record that has come due. Call it
+*			before the inputs are read, i.e. first thing in the
+*			fastest input task.
+*
+********************************************************************/
+void InputLog_Service(void)
+{
+	WORD now;
+	const rom INPUT_RECORD *r;
+
+	if(finished)
+		return;
+
+	now = Sched_Ticks() - startTick;
+
+	for(;;)
+	{
+		r = &session[cursor];
+		if(r->source == INPUT_SRC_END)
+		{
+			if(!SCHED_DUE(now, r->tick))
+				return;
+			finished = TRUE;
+			InputLog_Summary(now);
+			return;
+		}
+		if(!SCHED_DUE(now, r->tick))
+			return;
+
+		switch(r->source)
+		{
+			case INPUT_SRC_TOUCH:
+			if(r->arg < ADC_TOUCH_CHANNELS)
+				touch[r->arg] = r->v[0];
+			break;
+			case INPUT_SRC_BUTTON:
+			button = (BYTE)r->v[0];
+			break;
+			case INPUT_SRC_POT:
+			pot = r->v[0];
+			break;
+			case INPUT_SRC_ACCEL:
+			accel.x = r->v[0];
+			accel.y = r->v[1];
+			accel.z = r->v[2];
+			break;
+			default:								// decoded events are outputs
+			break;
+		}
+		cursor++;
+	}
+}
+
+WORD Input_ReadTouch(BYTE pad)
+{
+	return touch[pad];
+}
+
+BYTE Input_ReadButton(void)
+{
+	return button;
+}
+
+WORD Input_ReadPot(void)
+{
+	return pot;
+}
+
+BOOL Input_ReadAccel(BMA150_XYZ *xyz)
+{
+	*xyz = accel;
+	return TRUE;
+}
+
+void InputLog_Event(NAV_EVENT event)
+{
+	navCount++;
+}
+
+void InputLog_Dump(void)
+{
+}
+
+#endif
@@ -0,0 +1,109 @@
+/********************************************************************
+  File Information:
+    FileName:     	inputlog.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Input recorder and replay source. The scheduler tasks read the
+    touch pads, RB0, the pot and the BMA150 through the Input_Read*()
+    calls below instead of going to the drivers directly.
+
+    INPUTLOG_MODE selects what they do:
+
+      INPUTLOG_OFF      straight through to the drivers (macros)
+      INPUTLOG_RECORD   as OFF, and every change beyond a small dead
+                        band is appended, with its tick, to a RAM ring
+                        together with the navigation events decoded
+                        from it. InputLog_Dump() prints the ring on
+                        UART2 as C initialisers.
+      INPUTLOG_REPLAY   the hardware is ignored; readings come from
+                        the ROM session in inputlog_session.h, played
+                        back against the scheduler tick. A summary is
+                        printed on UART2 when the session ends.
+
+    Pasting a dump into inputlog_session.h turns a recorded session
+    into a replayable one, so the same navigation can be benchmarked
+    on different firmware builds or in a host build.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef INPUTLOG_H
+#define INPUTLOG_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "adc_sched.h"
+#include "accel.h"
+#include "nav.h"
+/*********************************************/
+
+#define INPUTLOG_OFF			0
+#define INPUTLOG_RECORD			1
+#define INPUTLOG_REPLAY			2
+
+#ifndef INPUTLOG_MODE
+#define INPUTLOG_MODE			INPUTLOG_OFF
+#endif
+
+// Record sources
+#define INPUT_SRC_TOUCH			0			// arg = pad, v[0] = raw level
+#define INPUT_SRC_BUTTON		1			// v[0] = RB0 level
+#define INPUT_SRC_POT			2			// v[0] = decimated ADRES
+#define INPUT_SRC_ACCEL			3			// v[0..2] = X, Y, Z raw counts
+#define INPUT_SRC_NAV			4			// arg = NAV_EVENT, decoded, not replayed
+#define INPUT_SRC_END			0xFF		// end of a session
+
+// RAM ring, placed in the INPUT_LOG section (see rm18f46j50_g.lkr)
+#define INPUTLOG_RECORDS		100
+
+// Changes smaller than these are not recorded
+#define INPUTLOG_TOUCH_DELTA	8
+#define INPUTLOG_POT_DELTA		16
+#define INPUTLOG_ACCEL_DELTA	2
+
+// UART2 transmit pin (PPS) and rate for dumps and replay summaries
+#define INPUTLOG_TX_RPOR		RPOR11
+#define INPUTLOG_TX_TRIS		TRISCbits.TRISC0
+#define INPUTLOG_BAUD			115200
+
+typedef struct
+{
+	WORD tick;								// Sched_Ticks() at the change
+	BYTE source;							// INPUT_SRC_xxx
+	BYTE arg;
+	SHORT v[3];
+} INPUT_RECORD;
+
+#if INPUTLOG_MODE == INPUTLOG_OFF
+
+#define InputLog_Init()
+#define InputLog_Service()
+#define InputLog_Event(event)
+#define InputLog_Dump()
+
+#define Input_ReadTouch(pad)	AdcSched_Touch(pad)
+#define Input_ReadButton()		(PORTBbits.RB0)
+#define Input_ReadPot()			AdcSched_Pot()
+#define Input_ReadAccel(xyz)	BMA150_ReadFresh(xyz)
+
+#else
+
+void InputLog_Init(void);
+void InputLog_Service(void);
+void InputLog_Event(NAV_EVENT event);
+void InputLog_Dump(void);
+
+WORD Input_ReadTouch(BYTE pad);
+BYTE Input_ReadButton(void);
+WORD Input_ReadPot(void);
+BOOL Input_ReadAccel(BMA150_XYZ *xyz);
+
+#endif
+
+#endif
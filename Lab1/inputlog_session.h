@@ -0,0 +1,70 @@
+/********************************************************************
+  File Information:
+    FileName:     	inputlog_session.h
+    Dependencies:   inputlog.h
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Session played back when INPUTLOG_MODE is INPUTLOG_REPLAY. Rows
+    are { tick, source, arg, { v0, v1, v2 } } in tick order and the
+    list must end with an INPUT_SRC_END row. InputLog_Dump() prints
+    the same rows, with the sources as numbers. Included inside an
+    initialiser by inputlog.c only.
+
+    This session opens Clothes > Men > T-Shirts:
+      - pot from the top of its travel down to "4 - Clothes", press
+      - "1 - Men" is highlighted on entry, press
+      - pot back up to "1 - Casual" and down to "4 - T-Shirts", press
+      - left pad leaves the action screen, up pad back to the main menu
+
+    Touch levels: 900 is an idle pad, the scroll pair reads 'u' with
+    up at 990 and down at 978, a side pad reads pressed below 800.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+	{    0, INPUT_SRC_TOUCH,  0, {  900,   0,   0 } },
+	{    0, INPUT_SRC_TOUCH,  1, {  900,   0,   0 } },
+	{    0, INPUT_SRC_TOUCH,  2, {  900,   0,   0 } },
+	{    0, INPUT_SRC_TOUCH,  3, {  900,   0,   0 } },
+	{    0, INPUT_SRC_BUTTON, 0, {    1,   0,   0 } },
+	{    0, INPUT_SRC_POT,    0, { 4000,   0,   0 } },
+	{    0, INPUT_SRC_ACCEL,  0, {    0,   0, 256 } },
+
+	// main menu: 2 - Electronics, 3 - Books, 4 - Clothes
+	{  500, INPUT_SRC_POT,    0, { 3000,   0,   0 } },
+	{  700, INPUT_SRC_POT,    0, { 2000,   0,   0 } },
+	{  900, INPUT_SRC_POT,    0, {  500,   0,   0 } },
+	{ 1500, INPUT_SRC_BUTTON, 0, {    0,   0,   0 } },
+	{ 1600, INPUT_SRC_BUTTON, 0, {    1,   0,   0 } },
+
+	// Clothes: open Men with the pot at the top
+	{ 2000, INPUT_SRC_POT,    0, { 4000,   0,   0 } },
+	{ 2500, INPUT_SRC_BUTTON, 0, {    0,   0,   0 } },
+	{ 2600, INPUT_SRC_BUTTON, 0, {    1,   0,   0 } },
+
+	// Men: down to T-Shirts and select it
+	{ 3000, INPUT_SRC_POT,    0, { 3000,   0,   0 } },
+	{ 3200, INPUT_SRC_POT,    0, { 2000,   0,   0 } },
+	{ 3400, INPUT_SRC_POT,    0, {  500,   0,   0 } },
+	{ 4000, INPUT_SRC_BUTTON, 0, {    0,   0,   0 } },
+	{ 4100, INPUT_SRC_BUTTON, 0, {    1,   0,   0 } },
+
+	// back out: left pad, then up pad twice
+	{ 5000, INPUT_SRC_TOUCH,  3, {  700,   0,   0 } },
+	{ 5100, INPUT_SRC_TOUCH,  3, {  900,   0,   0 } },
+	{ 5500, INPUT_SRC_TOUCH,  2, {  978,   0,   0 } },
+	{ 5500, INPUT_SRC_TOUCH,  1, {  990,   0,   0 } },
+	{ 5600, INPUT_SRC_TOUCH,  2, {  900,   0,   0 } },
+	{ 5600, INPUT_SRC_TOUCH,  1, {  900,   0,   0 } },
+	{ 6000, INPUT_SRC_TOUCH,  2, {  978,   0,   0 } },
+	{ 6000, INPUT_SRC_TOUCH,  1, {  990,   0,   0 } },
+	{ 6100, INPUT_SRC_TOUCH,  2, {  900,   0,   0 } },
+	{ 6100, INPUT_SRC_TOUCH,  1, {  900,   0,   0 } },
+
+	{ 7000, INPUT_SRC_END }
@@ -0,0 +1,192 @@
+/********************************************************************
+  File Information:
+    FileName:     	listview.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Scrolling list widget, see listview.h
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "listview.h"
+#include "oled.h"
+/*********************************************/
+
+#define FONT_FIRST				' '
+#define FONT_LAST				'~'
+#define FONT_WIDTH				5
+
+// Columns left over on the right of the last character
+#define ROW_TAIL				(SCREEN_HOR_SIZE - LIST_COLUMNS * (FONT_WIDTH + 1))
+
+
+/*********************************************************************
+* Function:  static void ListView_DrawRow(LISTVIEW *list, BYTE row)
+*
+* Overview: fetches and draws one viewport row across the full width
+*			of the display, inverted if it holds the cursor
+*
+********************************************************************/
+static void ListView_DrawRow(LISTVIEW *list, BYTE row)
+{
+	char text[LIST_COLUMNS + 1];
+	WORD item;
+	BYTE mask, i, col, letter;
+	BOOL ended;
+
+	item = list->top + row;
+	text[0] = 0;
+	if(item < list->count)
+		list->text(item, text);
+
+	mask = (item == list->cursor) ? 0xFF : 0x00;
+
+	WriteCommand(0xB0 + LIST_FIRST_PAGE + row);
+	WriteCommand(0x00 + (OFFSET & 0x0F));
+	WriteCommand(0x10 + ((OFFSET >> 4) & 0x0F));
+
+	ended = FALSE;
+	for(i = 0; i < LIST_COLUMNS; i++)
+	{
+		letter = ' ';
+		if(!ended)
+		{
+			if(text[i] == 0)
+				ended = TRUE;
+			else if(text[i] >= FONT_FIRST && text[i] <= FONT_LAST)
+				letter = text[i];
+		}
+		letter -= FONT_FIRST;
+
+		for(col = 0; col < FONT_WIDTH; col++)
+			WriteData(g_pucFont[letter][col] ^ mask);
+		WriteData(mask);
+	}
+
+	for(col = 0; col < ROW_TAIL; col++)
+		WriteData(mask);
+}
+
+/*********************************************************************
+* Function:  void ListView_Init(LISTVIEW *list, WORD count,
+*								LIST_TEXT text)
+*
+* Input: count - number of items
+*		 text - callback producing the text of one item
+*
+* Side Effects: none, every row is drawn by the next ListView_Render()
+*
+* Overview: puts the cursor on the first item
+*
+********************************************************************/
+void ListView_Init(LISTVIEW *list, WORD count, LIST_TEXT text)
+{
+	list->count = count;
+	list->cursor = 0;
+	list->top = 0;
+	list->text = text;
+	ListView_Invalidate(list);
+}
+
+/*********************************************************************
+* Function:  void ListView_Restore(LISTVIEW *list, WORD cursor,
+*								   WORD top)
+*
+* Input: cursor, top - a view saved from the cursor and top fields
+*
+* Side Effects: every row is drawn by the next ListView_Render()
+*
+* Overview: puts the list back exactly as it was shown, as long as
+*			the saved view still fits the item count
+*
+********************************************************************/
+void ListView_Restore(LISTVIEW *list, WORD cursor, WORD top)
+{
+	if(cursor < list->count && top <= cursor && cursor < top + LIST_ROWS)
+	{
+		list->cursor = cursor;
+		list->top = top;
+	}
+	else
+		ListView_MoveTo(list, cursor);
+
+	ListView_Invalidate(list);
+}
+
+/*********************************************************************
+* Function:  void ListView_Invalidate(LISTVIEW *list)
+*
+* Overview: marks every viewport row, for when the screen was
+*			overwritten by something else
+*
+********************************************************************/
+void ListView_Invalidate(LISTVIEW *list)
+{
+	list->dirty = (1 << LIST_ROWS) - 1;
+}
+
+/*********************************************************************
+* Function:  void ListView_MoveTo(LISTVIEW *list, WORD cursor)
+*
+* Input: cursor - new cursor item, clamped to the last item
+*
+* Overview: moves the cursor, scrolling the viewport just far enough
+*			to keep it visible, and marks the rows that changed
+*
+********************************************************************/
+void ListView_MoveTo(LISTVIEW *list, WORD cursor)
+{
+	WORD old;
+
+	if(list->count == 0)
+		return;
+	if(cursor >= list->count)
+		cursor = list->count - 1;
+	if(cursor == list->cursor)
+		return;
+
+	old = list->cursor;
+	list->cursor = cursor;
+
+	if(cursor < list->top)
+		list->top = cursor;
+	else if(cursor >= list->top + LIST_ROWS)
+		list->top = cursor - (LIST_ROWS - 1);
+	else
+	{
+		if(old >= list->top && old < list->top + LIST_ROWS)
+			list->dirty |= 1 << (BYTE)(old - list->top);
+		list->dirty |= 1 << (BYTE)(cursor - list->top);
+		return;
+	}
+
+	ListView_Invalidate(list);
+}
+
+/*********************************************************************
+* Function:  void ListView_Render(LISTVIEW *list)
+*
+* Overview: draws the marked rows; does nothing if none are
+*
+********************************************************************/
+void ListView_Render(LISTVIEW *list)
+{
+	BYTE row;
+
+	for(row = 0; list->dirty; row++)
+	{
+		if(list->dirty & 1)
+			ListView_DrawRow(list, row);
+		list->dirty >>= 1;
+	}
+}
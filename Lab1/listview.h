@@ -0,0 +1,59 @@
+/********************************************************************
+  File Information:
+    FileName:     	listview.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Scrolling list widget. The list only knows its item count and a
+    callback that produces the text of one item, so the items can
+    come from a ROM table or be generated; only the rows inside the
+    viewport are ever fetched or drawn. The cursor row is drawn
+    inverted.
+
+    Changing the list only marks the rows that need drawing;
+    ListView_Render() draws them, so a list that did not change costs
+    no display traffic. Moving the cursor inside the viewport marks
+    the two rows that changed. The controller cannot scroll part of
+    the screen (the title would move with the list), so moving the
+    viewport marks all LIST_ROWS visible rows - still O(visible) per
+    step, whatever the item count.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef LISTVIEW_H
+#define LISTVIEW_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+/*********************************************/
+
+#define LIST_ROWS				6			// rows in the viewport
+#define LIST_FIRST_PAGE			2			// display page of the first row
+#define LIST_COLUMNS			21			// characters per row
+
+// Writes the NUL terminated text of an item, at most LIST_COLUMNS
+// characters, into text. Shorter text is padded with blanks.
+typedef void (*LIST_TEXT)(WORD index, char *text);
+
+typedef struct
+{
+	WORD count;
+	WORD cursor;
+	WORD top;								// item shown on the first row
+	LIST_TEXT text;
+	BYTE dirty;								// bit n: row n needs drawing
+} LISTVIEW;
+
+void ListView_Init(LISTVIEW *list, WORD count, LIST_TEXT text);
+void ListView_Restore(LISTVIEW *list, WORD cursor, WORD top);
+void ListView_Invalidate(LISTVIEW *list);
+void ListView_MoveTo(LISTVIEW *list, WORD cursor);
+void ListView_Render(LISTVIEW *list);
+
+#endif
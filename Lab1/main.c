@@ -59,6 +59,23 @@
 
 #include "soft_start.h"
 
+#include "adc_sched.h"
+
+#include "accel.h"
+#include "gesture.h"
+
+#include "sched.h"
+
+#include "inputlog.h"
+
+#include "input.h"
+
+#include "menu.h"
+
+#include "screen.h"
+
+#include "nvstore.h"
+
 
 //	========================	CONFIGURATION	========================
 
@@ -126,8 +143,88 @@ static void ProcessIO(void);
 static void UserInit(void);
 static void YourHighPriorityISRCode();
 static void YourLowPriorityISRCode();
+static void SleepUntilMotion(void);
 
-BOOL CheckButtonPressed(void);
+//	========================	SCHEDULED TASKS	========================
+static rom SCHED_TASK appTasks[] =
+{
+	{ Input_TouchTask,	SCHED_MS(10) },			//touch pads and push button, 100 Hz
+	{ Input_PotTask,	SCHED_MS(20) },			//potentiometer, 50 Hz
+	{ Input_AccelTask,	SCHED_MS(20) }			//gestures, 50 Hz (BMA150 data rate)
+};
+
+//	========================	MENU TREE	========================
+static rom MENU_ITEM menItems[] =
+{
+	{ "1 - Casual           ", 0, 1 },
+	{ "2 - Shoes            ", 0, 2 },
+	{ "3 - Pants            ", 0, 3 },
+	{ "4 - T-Shirts         ", 0, 4 }
+};
+static rom MENU_NODE menuMen =
+	{ "Men                  ", menItems, 4, MENU_INPUT_POT, 0 };
+
+static rom MENU_ITEM homeKitchenItems[] =
+{
+	{ "1 - Furnitures       ", 0, 1 },
+	{ "2 - Kitchen Tools    ", 0, 2 },
+	{ "3 - Garden           ", 0, 3 },
+	{ "4 - Other            ", 0, 4 }
+};
+static rom MENU_NODE menuHomeKitchen =
+	{ "Home&Kitchen         ", homeKitchenItems, 4, MENU_INPUT_TILT, MENU_FLAG_RIGHT_OPENS };
+
+static rom MENU_ITEM electronicsItems[] =
+{
+	{ "1.Electronics Item1  ", 0,  1 },
+	{ "2.Electronics Item2  ", 0,  2 },
+	{ "3.Electronics Item3  ", 0,  3 },
+	{ "4.Electronics Item4  ", 0,  4 },
+	{ "5.Electronics Item5  ", 0,  5 },
+	{ "6.Electronics Item6  ", 0,  6 },
+	{ "7.Electronics Item7  ", 0,  7 },
+	{ "8.Electronics Item8  ", 0,  8 },
+	{ "9.Electronics Item9  ", 0,  9 },
+	{ "10.Electronics Item10", 0, 10 },
+	{ "11.Electronics Item11", 0, 11 },
+	{ "12.Electronics Item12", 0, 12 },
+	{ "13.Electronics Item13", 0, 13 },
+	{ "14.Electronics Item14", 0, 14 },
+	{ "15.Electronics Item15", 0, 15 },
+	{ "16.Electronics Item16", 0, 16 }
+};
+static rom MENU_NODE menuElectronics =
+	{ "Electronics          ", electronicsItems, 16, MENU_INPUT_SCROLL, 0 };
+
+static rom MENU_ITEM booksItems[] =
+{
+	{ "1 - Romans           ", 0, 1 },
+	{ "2 - Action           ", 0, 2 },
+	{ "3 - Kids             ", 0, 3 },
+	{ "4 - Cooking          ", 0, 4 }
+};
+static rom MENU_NODE menuBooks =
+	{ "Books                ", booksItems, 4, MENU_INPUT_SIDE, 0 };
+
+static rom MENU_ITEM clothesItems[] =
+{
+	{ "1 - Men              ", &menuMen, 1 },
+	{ "2 - Women            ", 0, 2 },
+	{ "3 - TRF              ", 0, 3 },
+	{ "4 - Kids             ", 0, 4 }
+};
+static rom MENU_NODE menuClothes =
+	{ "Clothes              ", clothesItems, 4, MENU_INPUT_SIDE, 0 };
+
+static rom MENU_ITEM homeItems[] =
+{
+	{ "1 - Home&Kitchen     ", &menuHomeKitchen, 1 },
+	{ "2 - Electronics      ", &menuElectronics, 2 },
+	{ "3 - Books            ", &menuBooks, 3 },
+	{ "4 - Clothes          ", &menuClothes, 4 }
+};
+static rom MENU_NODE menuHome =
+	{ "Welcome To Amazon    ", homeItems, 4, MENU_INPUT_POT, 0 };
 
 //	========================	VECTOR REMAPPING	========================
 #if defined(__18CXX)
@@ -206,13 +303,21 @@ BOOL CheckButtonPressed(void);
   
 //	========================	Application Interrupt Service Routines	========================
   //These are your actual interrupt handling routines.
-  #pragma interrupt YourHighPriorityISRCode
+  //The handlers called from here use compiler temporaries, so .tmpdata
+  //must be preserved along with the default context.
+  #pragma interrupt YourHighPriorityISRCode save=section(".tmpdata")
   void YourHighPriorityISRCode()
   {
     //Check which interrupt flag caused the interrupt.
     //Service the interrupt
     //Clear the interrupt flag
     //Etc.
+    if(PIE1bits.ADIE && PIR1bits.ADIF)
+      AdcSched_ISR();
+    if(INTCON3bits.INT1IE && INTCON3bits.INT1IF)
+      Accel_ISR();
+    if(PIE1bits.TMR2IE && PIR1bits.TMR2IF)
+      Sched_ISR();
   
   } //This return will be a "retfie fast", since this is in a #pragma interrupt section 
   #pragma interruptlow YourLowPriorityISRCode
@@ -252,16 +357,39 @@ BOOL CheckButtonPressed(void);
  *****************************************************************************/
 void UserInit(void)
 {
+  WORD warmStart;
+
+  /* The last menu view; holding the button through reset starts cold */
+  NvStore_Init();
+  if(PORTBbits.RB0 == 0)
+    NvStore_Erase();
 
   /* Initialize the mTouch library */
   mTouchInit();
 
-  /* Call the mTouch callibration function */
-  mTouchCalibrate();
+  /* Call the mTouch callibration function, only needed on a cold start */
+  if(!NvStore_Read(NV_KEY_MENU_DEPTH, &warmStart))
+    mTouchCalibrate();
+
+  /* Hand the A/D converter over to the scheduler (pot + touch pads) */
+  AdcSched_Init();
 
   /* Initialize the accelerometer */
   InitBma150(); 
 
+  /* Samples are read when the BMA150 flags new data on INT1 */
+  Accel_InitInterrupts();
+  Gesture_Init();
+
+  /* Sample the inputs at fixed rates and pace the UI loops */
+  Sched_Init(appTasks, sizeof(appTasks) / sizeof(appTasks[0]));
+
+  /* Input recorder / replay source, when built in */
+  InputLog_Init();
+
+  /* Latched touch, button, pot and gesture input for the menus */
+  Input_Init();
+
   /* Initialize the oLED Display */
    ResetDevice();  
    FillDisplay(0x00);
@@ -308,658 +436,48 @@ static void InitializeSystem(void)
 
 //	========================	Application Code	========================
 
-BOOL CheckButtonPressed(void)
-{
-    static char buttonPressed = FALSE;
-    static unsigned long buttonPressCounter = 0;
-
-    if(PORTBbits.RB0 == 0)
-    {
-        if(buttonPressCounter++ > 10)
-        {
-            buttonPressCounter = 0;
-            buttonPressed = TRUE;
-        }
-    }
-    else
-    {
-        if(buttonPressed == TRUE)
-        {
-            if(buttonPressCounter == 0)
-            {
-                buttonPressed = FALSE;
-                return TRUE;
-            }
-            else
-            {
-                buttonPressCounter--;
-            }
-        }
-    }
-
-    return FALSE;
-}
-
-
-int accelerometer()
-{
-	BMA150_XYZ xyz;
-	char xyArr[20] = {0};	
-	BYTE lsb, msb;
-	int i, val, repeat = 0;
-	int counterX = 0;
-	int counterY = 0;
-
-	lsb = BMA150_ReadByte(BMA150_ACC_X_LSB); 	
-	msb = BMA150_ReadByte(BMA150_ACC_X_MSB); 	
-	xyz.x = 0;
-	xyz.x = (short)msb << 8;
-	xyz.x |= lsb;
-	xyz.x >>= 6;
-	if(xyz.x & 0x200)
-		xyz.x |= 0xFC00;
-
-	xyz.x = xyz.x << 2;		
-	itoa(xyz.x, xyArr);
-	val = atoi(xyArr);
-	if(val > counterX)
-		counterX = val;
-
-	repeat = counterX / 50;
-	lsb = BMA150_ReadByte(BMA150_ACC_Y_LSB); 	
-	msb = BMA150_ReadByte(BMA150_ACC_Y_MSB); 	
-	xyz.y = 0;
-	xyz.y = (short)msb << 8;
-	xyz.y |= lsb;
-	xyz.y >>= 6;
-	if(xyz.y & 0x200)
-		xyz.y |= 0xFC00;
-
-	xyz.x = xyz.x << 2;
-	itoa(xyz.y, xyArr);
-	val = atoi(xyArr);
-	if(val > counterY)
-		counterY = val;
-
-	//z
-	lsb = BMA150_ReadByte(BMA150_ACC_Z_LSB); //LSB	
-	msb = BMA150_ReadByte(BMA150_ACC_Z_MSB); //MSB	
-	xyz.z = 0;
-	xyz.z = (short)msb << 8;
-	xyz.z |= lsb;
-	xyz.z >>= 6;
-	if(xyz.z & 0x200)
-		xyz.z |= 0xFC00;
-
-	itoa(xyz.z, xyArr);
-	val = atoi(xyArr);
-
-	//chack if microchip is upside down
-	if(val < -58)
-	{
-		counterY = 0;
-		counterX = 0;
-		repeat = 1;
-		oledRepeatByte(0x18,5,55, repeat);
-		oledRepeatByte(0x18,4,55, repeat);
-		return 1;
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-
-
-int accelerometer2()
-{
-	BMA150_XYZ xyz;
-	char xyArr[20] = {0};	
-	BYTE lsb, msb;
-	int i, val, repeat = 0;
-	int counterX = 0;
-	int counterY = 0;
-
-	//accX
-	for(i=13;i <= 40;i++)
-		oledWriteChar1x(0x20, 4 + 0xB0, i);						//clear garbage oled parameter
-
-	lsb = BMA150_ReadByte(BMA150_ACC_X_LSB); 	
-	msb = BMA150_ReadByte(BMA150_ACC_X_MSB); 	
-	xyz.x = 0;
-	xyz.x = (short)msb << 8;
-	xyz.x |= lsb;
-	xyz.x >>= 6;
-	if(xyz.x & 0x200)
-		xyz.x |= 0xFC00;
-
-	xyz.x = xyz.x << 2;		
-	
-	itoa(xyz.x, xyArr);
-	//oledPutROMString((ROM_STRING)"X: ",4,0);
-	//oledPutString(xyArr, 4, 15);
-	if(xyz.x >= 0 && xyz.x <= 50)
-		return 1;
-	else if(xyz.x >= 51  && xyz.x <= 100)
-		return 2;
-	else if(xyz.x >= 101 && xyz.x <= 150)
-		return 3;
-	else if(xyz.x >= 151 && xyz.x <= 200)
-		return 4;
-	else 
-		return 1;
-}
-
-
-char touchButtons()
-{
-	unsigned int left, right,scrollU, scrollD;;
-
-	mTouchCalibrate();
-	right  = mTouchReadButton(0);
-	left   = mTouchReadButton(3);
-	scrollU = mTouchReadButton(1);
-	scrollD = mTouchReadButton(2);
-	ADCON0 = 0b00010011;								//potentiometer declire again 								
-
-
-	//check  scroll			
-	if(scrollD > 980)
-		return 'd';
-	if(scrollD < 975)
-		return 'x';
-	if(scrollU > 965)
-		return 'u';
-	if(scrollU < 960)
-		return 'x';
-
-}
-
-char touchButtons2()
-{
-	unsigned int left, right,scrollU, scrollD;;
-
-	mTouchCalibrate();
-	right  = mTouchReadButton(0);
-	left   = mTouchReadButton(3);
-	scrollU = mTouchReadButton(1);
-	scrollD = mTouchReadButton(2);
-	ADCON0 = 0b00010011;
-	
-	//check left touch
-	if(left > 800)
-	  return 'x';
-	else
-      return 'l';
-
-}
-
-char touchButtons3()
-{
-	unsigned int left, right,scrollU, scrollD;;
-
-	mTouchCalibrate();
-	right  = mTouchReadButton(0);
-	left   = mTouchReadButton(3);
-	scrollU = mTouchReadButton(1);
-	scrollD = mTouchReadButton(2);
-	ADCON0 = 0b00010011;
-	
-	//check right touch
-	if(right > 800)
-	  return 'x';
-	else
-      return 'r';
-
-}
-
-
-int potentiometer()
-{
-	int i;
-	char str[30];
-
-	ADCON0bits.CHS = 4;		
-	ADCON0bits.GO = 1;	
-	while(ADCON0bits.GO);
-
-	itoa(ADRES, str);					
-
-	//Fill the selected item in main menu bt potentimeter current value
-	if(ADRES < 1000 && ADRES > 750){FillDisplayItem(0xFF,0xB2,0xB3); return 1;}
-	if(ADRES < 750 && ADRES > 500){FillDisplayItem(0xFF,0xB3,0xB4); return 2;}
-	if(ADRES < 500 && ADRES > 250){FillDisplayItem(0xFF,0xB4,0xB5); return 3;}
-	if(ADRES < 250 && ADRES > 0){FillDisplayItem(0xFF,0xB5,0xB6); return 4;}
-	
-}
-
-int potentiometerSubMenu2()
-{
-	int i;
-	char str[30];
-
-	ADCON0bits.CHS = 4;		
-	ADCON0bits.GO = 1;	
-	while(ADCON0bits.GO);
-
-	itoa(ADRES, str);					
-
-	//Fill the selected item in main menu bt potentimeter current value
-	if(ADRES < 1000 && ADRES > 750){FillDisplayItem(0xFF,0xB2,0xB3); return 1;}
-	else if(ADRES < 750 && ADRES > 600){FillDisplayItem(0xFF,0xB3,0xB4); return 2;}
-	else if(ADRES < 600 && ADRES > 450){FillDisplayItem(0xFF,0xB4,0xB5); return 3;}
-	else if(ADRES < 450 && ADRES > 300){FillDisplayItem(0xFF,0xB5,0xB6); return 4;}
-	else if(ADRES < 300 ){FillDisplayItem(0xFF,0xB6,0xB7); return 5;}
-    else if(ADRES < 150 && ADRES >0){FillDisplayItem(0xFF,0xB7,0xB8); return 6;}
-	else{FillDisplayItem(0xFF,0xB2,0xB3); return 6;}
-}
-
-void DrawMainMenu(void)
-{
-	oledPutROMString("Welcome To Amazon    ",0,0) ;
-	oledPutROMString(" ",1,0) ;
-	oledPutROMString("1 - Home&Kitchen     ",2,0) ;
-	oledPutROMString("2 - Electronics      ",3,0) ;
-	oledPutROMString("3 - Books            ",4,0) ;	
-	oledPutROMString("4 - Clothes          ",5,0) ;
-	oledPutROMString("                     ",6,0) ;
-	oledPutROMString("                     ",7,0);
-}
-
-void DrawSubMenu1()
-{
-	int res = 0;
-	char button = 'q';
-	int action = 0;
-	int select = 0;
-	char response = 'q';
-	while(1)
-	{
-		response = touchButtons();
-		if(	response == 0x75)
-			break;
-
-			button = touchButtons3();
-			if(button == 'r')
-			{
-				action = 1;
-				
-				while(action == 1)
-				{			
-					action = drawActionOnScreen(select);	
-				}				
-			}
-		
-		oledPutROMString("Home&Kitchen         ",0,0) ;
-		oledPutROMString(" ",1,0) ;
-		oledPutROMString("1 - Furnitures       ",2,0) ;
-		oledPutROMString("2 - Kitchen Tools    ",3,0) ;
-		oledPutROMString("3 - Garden           ",4,0) ;	
-		oledPutROMString("4 - Other            ",5,0) ;
-		oledPutROMString("                     ",6,0) ;
-		res = accelerometer2();
-		switch(res)
-			{
-				case 1:
-				FillDisplayItem2(0xFF,0xB2,0xB3);
-				select = 1;
-				break;
-				case 2:
-				FillDisplayItem2(0xFF,0xB3,0xB4);
-				select = 2;
-				break;
-				case 3:
-				FillDisplayItem2(0xFF,0xB4,0xB5);
-				select = 3;				
-				break;
-				case 4: 
-				FillDisplayItem2(0xFF,0xB5,0xB6);
-				select = 4;				
-				break;
-			}
-		
-	}
-}
-
-int drawActionOnScreen(int action)
+/********************************************************************
+ * Function:        static void SleepUntilMotion(void)
+ *
+ * PreCondition:    Accel_InitInterrupts() has been called
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    A/D schedule is stopped while asleep
+ *
+ * Overview:        Puts the MCU to sleep until the BMA150 any-motion
+ *                  detector fires. The display keeps its contents.
+ *                  The watchdog (WDTPS 1:32768, about 2 minutes) also
+ *                  wakes it, and it stays awake if the board has
+ *                  moved since it fell asleep, so a missed INT1 edge
+ *                  cannot leave it asleep for good.
+ *
+ * Note:            Returns straight away if the board is moving.
+ *******************************************************************/
+static void SleepUntilMotion(void)
 {
+	BMA150_XYZ rest;
 
-	int response2 = 0;
-	while(1)
-	{
-		char str[30];
-		itoa(action, str);					
-		oledPutString(str, 4, 40);	
-		oledPutROMString("                     ",2,0) ;
-		oledPutROMString("                     ",3,0) ;
-		oledPutROMString("Action   was pressed ",4,0) ;
-		oledPutROMString("      press left     ",5,0) ;
-		oledPutROMString("      to go back     ",6,0) ;
-		oledPutROMString("                     ",7,0);
-
-		response2 = touchButtons2();
-	if(1)
-	{
-	char str[30];
-	itoa(response2, str);					
-	//oledPutString(str, 2, 0);	
-	}
-
-		if(response2 != 'x')
-		{
-			return 0;
-		}
-		else
-		{
-			return 1;
-			break;
-		}
-	}
-}
+	AdcSched_Suspend();
 
-int DrawSubMenu2()
-{
-	BOOL button;
-	char response;
-	char response2;
-	int counterDown = 0;
-	int action = 0;
-	int acceler = 0;
-	response = 'q';
-	response2 = 'q';
-	while(1)
+	if(Accel_ArmMotionWake())
 	{
-			acceler = accelerometer();				
-			if(acceler == 1)
-				break;
-
-			button = CheckButtonPressed();
-			if(button)
-			{
-				action = 1;
-				
-				while(action == 1)
-				{			
-					action = drawActionOnScreen(counterDown);	
-
-				}				
-			}
-
-		if(counterDown >=0  && counterDown <=5)
+		BMA150_ReadXYZ(&rest);
+		OSCCONbits.IDLEN = 0;
+		do
 		{
-			oledPutROMString("Electronics          ",0,0) ;
-			oledPutROMString(" ",1,0) ;
-			oledPutROMString("1.Electronics Item1  ",2,0) ;
-			oledPutROMString("2.Electronics Item2  ",3,0) ;
-			oledPutROMString("3.Electronics Item3  ",4,0) ;	
-			oledPutROMString("4.Electronics Item4  ",5,0) ;
-			oledPutROMString("5.Electronics Item5  ",6,0) ;
-			oledPutROMString("6.Electronics Item6  ",7,0) ;
+			WDTCONbits.SWDTEN = 1;
+			Sleep();
+			Nop();
+			WDTCONbits.SWDTEN = 0;
 		}
-	
-		response = touchButtons();
-		if(response == 0x64){
-			counterDown = counterDown + 1;	
-		}
-			
-		if(	response == 0x75)
-			counterDown = counterDown - 1;
-
-		if(counterDown >=6 && counterDown <=11 )
-		{
-			oledPutROMString("Electronics          ",0,0) ;
-			oledPutROMString(" ",1,0) ;
-			oledPutROMString("7.Electronics Item7  ",2,0) ;
-			oledPutROMString("8.Electronics Item8  ",3,0) ;
-			oledPutROMString("9.Electronics Item9  ",4,0) ;	
-			oledPutROMString("10.Electronics Item10",5,0) ;
-			oledPutROMString("11.Electronics Item11",6,0) ;
-			oledPutROMString("12.Electronics Item12",7,0) ;
-		}
-		if(counterDown >=12 && counterDown <=15 )
-		{
-			oledPutROMString("Electronics          ",0,0) ;
-			oledPutROMString(" ",1,0) ;
-			oledPutROMString("11.Electronics Item11",2,0) ;
-			oledPutROMString("12.Electronics Item12",3,0) ;
-			oledPutROMString("13.Electronics Item13",4,0) ;	
-			oledPutROMString("14.Electronics Item14",5,0) ;
-			oledPutROMString("15.Electronics Item15",6,0) ;
-			oledPutROMString("16.Electronics Item16",7,0) ;
-		}
-
-		if(counterDown >= 15)
-			counterDown = 15;
-			
-		if(counterDown <= 0){
-			counterDown = 0;
-		}
-
-		
-			switch(counterDown)
-			{
-				case 0: case 10: case 6:
-				FillDisplayItem2(0xFF,0xB2,0xB3);
-				break;
-				case 1: case 11: case 7:
-				FillDisplayItem2(0xFF,0xB3,0xB4);
-				break;
-				case 2: case 12: case 8:
-				FillDisplayItem2(0xFF,0xB4,0xB5);
-				break;
-				case 3: case 13: case 9:
-				FillDisplayItem2(0xFF,0xB5,0xB6);
-				break;
-				case 4: case 14:
-				FillDisplayItem2(0xFF,0xB6,0xB7);
-				break;
-				case 5:case 15:
-				FillDisplayItem2(0xFF,0xB7,0xB8);
-				break;
-				default:
-				break;
-			}		
-  	}
-	return 0;
-}
-
-void DrawSubMenu3()
-{
-	char response = 'q';
-	char response2 = 'q';
-	char response3 = 'q';
-	int counter = 0;
-	int action = 0;
-	BOOL button;
-	while(1)
-	{
-		response3 = touchButtons();
-		if(	response3 == 0x75)
-			break;
-
-		button = CheckButtonPressed();
-			if(button)
-			{
-				action = 1;
-				
-				while(action == 1)
-				{			
-					action = drawActionOnScreen(counter + 1);	
-
-				}				
-			}
-
-		oledPutROMString("Books                ",0,0) ;
-		oledPutROMString(" ",1,0) ;
-		oledPutROMString("1 - Romans           ",2,0) ;
-		oledPutROMString("2 - Action           ",3,0) ;
-		oledPutROMString("3 - Kids             ",4,0) ;	
-		oledPutROMString("4 - Cooking          ",5,0) ;
-		oledPutROMString("                     ",6,0);
-	
-	//left
-	response = touchButtons2();
-	//right
-	response2 = touchButtons3();
-	
-	if(response != 'x' && counter > 0)
-	{
-		counter -= 1;
-	}
-	if(response2 != 'x')
-	{
-		counter +=1;
-	} 
-	if(counter <= 0)
-		counter = 0;
-	if(counter >= 3)
-		counter =3;
-
-	switch(counter)
-			{
-				case 0:
-				FillDisplayItem(0xFF,0xB2,0xB3);
-				break;
-				case 1: 
-				FillDisplayItem(0xFF,0xB3,0xB4);
-				break;
-				case 2: 
-				FillDisplayItem(0xFF,0xB4,0xB5);
-				break;
-				case 3: 
-				FillDisplayItem(0xFF,0xB5,0xB6);
-				break;
-				default:
-				break;
-			}
+		while(!RCONbits.TO && !Accel_MovedSince(&rest));	//TO clear: watchdog wake
 	}
-	
-}
-
-void DrawSubMenu4()
-{
-char response = 'q';
-	char response2 = 'q';
-	char response3 = 'q';
-	char response4 = 'q';
-	int counter = 0;
-	int action = 0;
-	int action2 = 0;
-	int action3 = 0;
-	int selection = 0;
-	BOOL button;
-	BOOL button2;
-	BOOL button3;
-	while(1)
-	{
-		response3 = touchButtons();
-		if(	response3 == 0x75)
-			break;
-
-		button = CheckButtonPressed();
-		if(button)
-		{
-			action = 1;
-		
-			while(action == 1 && (counter == 1 || counter == 2 || counter == 3))
-			{			
-				action = drawActionOnScreen(counter+1);	
-		
-			}				
-
-			while(action == 1 && counter == 0)
-			{		
-				selection = potentiometer();
-
-				response4 = touchButtons();
-				if(	response4 == 0x75)
-					break;
-
-				oledPutROMString("Men                  ",0,0);
-				oledPutROMString(" ",1,0);
-				oledPutROMString("1 - Casual           ",2,0);
-				oledPutROMString("2 - Shoes            ",3,0);
-				oledPutROMString("3 - Pants            ",4,0);	
-				oledPutROMString("4 - T-Shirts         ",5,0);
-				oledPutROMString("                     ",6,0);
-			
-					switch(selection)
-					{
-						case 1:
-						FillDisplayItem(0xFF,0xB2,0xB3);
-						break;
-						case 2: 
-						FillDisplayItem(0xFF,0xB3,0xB4);
-						break;
-						case 3: 
-						FillDisplayItem(0xFF,0xB4,0xB5);
-						break;
-						case 4: 
-						FillDisplayItem(0xFF,0xB5,0xB6);
-						break;
-						default:
-						break;
-					}
-				button2 = CheckButtonPressed();
-				if(button2)
-				{
-					action2 = 1;
-					
-					while(action2 == 1)
-					{			
-						action2 = drawActionOnScreen(selection);	
-	
-					}				
-				}
-			}				
-		}
-
 
-		oledPutROMString("Clothes              ",0,0);
-		oledPutROMString(" ",1,0);
-		oledPutROMString("1 - Men              ",2,0);
-		oledPutROMString("2 - Women            ",3,0);
-		oledPutROMString("3 - TRF              ",4,0);	
-		oledPutROMString("4 - Kids             ",5,0);
-		oledPutROMString("                     ",6,0);
-
-		//left
-		response = touchButtons2();
-		//right
-		response2 = touchButtons3();
-		
-		if(response != 'x' && counter > 0)
-		{
-			counter -= 1;
-		}
-		if(response2 != 'x')
-		{
-			counter +=1;
-		} 
-		if(counter <= 0)
-			counter = 0;
-		if(counter >= 3)
-			counter =3;
-	
-		switch(counter)
-		{
-			case 0:
-			FillDisplayItem(0xFF,0xB2,0xB3);
-			break;
-			case 1: 
-			FillDisplayItem(0xFF,0xB3,0xB4);
-			break;
-			case 2: 
-			FillDisplayItem(0xFF,0xB4,0xB5);
-			break;
-			case 3: 
-			FillDisplayItem(0xFF,0xB5,0xB6);
-			break;
-			default:
-			break;
-		}
-	}
+	Accel_ArmDataReady();
+	AdcSched_Resume();
 }
 
 /********************************************************************
@@ -979,38 +497,24 @@ char response = 'q';
  *******************************************************************/
 void main(void)
 {
-	int selection;
-	BOOL button;
-
     InitializeSystem();
 
+	Menu_Start(&menuHome);
+
     while(1) //Main is Usualy an Endless Loop
     {
+		Sched_WaitFrame();
 
-		DrawMainMenu();
-		selection = potentiometer();
+		//one frame of the open screen; NAV_HOME is a shake at the root menu
+		if(Screen_Step(Input_TakeEvent()) == NAV_HOME)
+			InputLog_Dump();
 
-		button = CheckButtonPressed();
-		if(button)
+		//nothing happening; keep the view for the next reset and sleep
+		if(Screen_Idle(MENU_IDLE_FRAMES))
 		{
-			switch(selection)
-			{
-				case 1:
-				DrawSubMenu1();
-				break;
-				case 2:
-				DrawSubMenu2();
-				break;
-				case 3:
-				DrawSubMenu3();
-				break;
-				case 4:
-				DrawSubMenu4();
-				break;
-			
-			}
+			Menu_Save();
+			SleepUntilMotion();
 		}
-//touchButtons();
     }
 }//end main
 
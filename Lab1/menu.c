@@ -0,0 +1,406 @@
+/********************************************************************
+  File Information:
+    FileName:     	menu.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Menu engine, see menu.h
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "menu.h"
+#include "screen.h"
+#include "input.h"
+#include "gesture.h"
+#include "listview.h"
+#include "oled.h"
+#include "nvstore.h"
+#include <stdlib.h>
+/*********************************************/
+
+#define ROM_STRING rom unsigned char*
+
+static rom char blankRow[] = "                     ";
+
+static NAV_EVENT Menu_HandleEvent(NAV_EVENT event);
+static void Menu_Enter(void);
+static void Menu_Render(void);
+static NAV_EVENT Action_HandleEvent(NAV_EVENT event);
+static void Action_Enter(void);
+static void Action_Render(void);
+static void Action_ClearRows(void);
+
+static rom SCREEN menuScreen = { Menu_Enter, Menu_HandleEvent, Menu_Render, NULL };
+static rom SCREEN actionScreen = { Action_Enter, Action_HandleEvent, Action_Render, NULL };
+
+static const rom MENU_NODE *node;			// node on the menu screen
+static LISTVIEW list;
+static BYTE absolute;						// last pot item or tilt band seen
+static BOOL titleDirty;
+static BOOL actionDirty;
+
+
+/*********************************************************************
+* Function:  static NAV_EVENT Menu_Decode(NAV_EVENT event)
+*
+* Input: event - button or gesture event of this frame
+*
+* Overview: adds the touch pads to the frame's event and puts it in
+*			the terms of the node's input method
+*
+********************************************************************/
+static NAV_EVENT Menu_Decode(NAV_EVENT event)
+{
+	if(event != NAV_NONE)
+	{
+		// tilts only steer the relative input methods
+		if(event >= NAV_UP && event <= NAV_RIGHT &&
+		   (node->input == MENU_INPUT_POT || node->input == MENU_INPUT_TILT))
+			return NAV_NONE;
+		return event;
+	}
+
+	event = Input_ScrollPad();
+	if(event == NAV_UP && node->input != MENU_INPUT_SCROLL)
+		return NAV_BACK;
+	if(event != NAV_NONE)
+		return event;
+
+	if(Input_LeftPad())
+		return NAV_LEFT;
+	if(Input_RightPad())
+		return NAV_RIGHT;
+
+	return NAV_NONE;
+}
+
+/*********************************************************************
+* Function:  static void Menu_ItemText(WORD index, char *text)
+*
+* Overview: list view callback, copies an item label out of ROM
+*
+********************************************************************/
+static void Menu_ItemText(WORD index, char *text)
+{
+	const rom char *label;
+	BYTE i;
+
+	label = node->items[index].label;
+	for(i = 0; i < LIST_COLUMNS && label[i]; i++)
+		text[i] = label[i];
+	text[i] = 0;
+}
+
+/*********************************************************************
+* Function:  static BYTE Menu_Absolute(void)
+*
+* Output: the item the pot or the tilt points at, for the absolute
+*		  input methods
+*
+********************************************************************/
+static BYTE Menu_Absolute(void)
+{
+	if(node->input == MENU_INPUT_POT)
+		return Input_PotItem();
+	return Gesture_TiltBand();
+}
+
+/*********************************************************************
+* Function:  static void Menu_Enter(void)
+*
+* Overview: menu screen enter handler. Shows the node in the screen
+*			frame: a new frame starts where the absolute input points
+*			(or at the top), an uncovered one exactly as it was
+*			left. Marks the whole screen for drawing.
+*
+********************************************************************/
+static void Menu_Enter(void)
+{
+	SCREEN_FRAME *frame;
+	BOOL isAbsolute;
+
+	frame = Screen_Top();
+	node = (const rom MENU_NODE *)frame->arg;
+
+	isAbsolute = TRUE;
+	if(node->input == MENU_INPUT_POT)
+		Input_SetPotItems(node->count);
+	else if(node->input == MENU_INPUT_TILT)
+		Gesture_SetTiltBands(node->count);
+	else
+		isAbsolute = FALSE;
+
+	ListView_Init(&list, node->count, Menu_ItemText);
+
+	if(frame->cursor == SCREEN_NEW_VIEW)
+	{
+		if(isAbsolute)
+			ListView_MoveTo(&list, Menu_Absolute());
+		frame->cursor = list.cursor;
+		frame->top = list.top;
+	}
+	else
+		ListView_Restore(&list, frame->cursor, frame->top);
+
+	// the pot or the tilt moves the selection once it leaves this item
+	if(isAbsolute)
+		absolute = Menu_Absolute();
+
+	titleDirty = TRUE;
+}
+
+/*********************************************************************
+* Function:  static NAV_EVENT Menu_HandleEvent(NAV_EVENT event)
+*
+* Output: NAV_BACK or NAV_HOME to leave the screen, NAV_NONE
+*
+* Overview: menu screen event handler. Moves the selection or opens
+*			the selected item: a child node on a new menu screen, a
+*			leaf on the action screen.
+*
+********************************************************************/
+static NAV_EVENT Menu_HandleEvent(NAV_EVENT event)
+{
+	SCREEN_FRAME *frame;
+	BYTE sel, now;
+	BOOL open;
+	const rom MENU_ITEM *item;
+
+	frame = Screen_Top();
+	open = FALSE;
+	event = Menu_Decode(event);
+	sel = (BYTE)frame->cursor;
+
+	if(node->input == MENU_INPUT_POT || node->input == MENU_INPUT_TILT)
+	{
+		now = Menu_Absolute();
+		if(now != absolute)
+		{
+			absolute = now;
+			sel = now;
+		}
+	}
+
+	switch(event)
+	{
+		case NAV_UP:
+		if(node->input == MENU_INPUT_SCROLL && sel > 0)
+			sel--;
+		break;
+		case NAV_DOWN:
+		if(node->input == MENU_INPUT_SCROLL && sel + 1 < node->count)
+			sel++;
+		break;
+		case NAV_LEFT:
+		if(node->input == MENU_INPUT_SIDE && sel > 0)
+			sel--;
+		break;
+		case NAV_RIGHT:
+		if(node->input == MENU_INPUT_SIDE)
+		{
+			if(sel + 1 < node->count)
+				sel++;
+			break;
+		}
+		if(!(node->flags & MENU_FLAG_RIGHT_OPENS))
+			break;
+		// fall through, the right pad opens like the button
+		case NAV_SELECT:
+		open = TRUE;
+		break;
+		case NAV_BACK:
+		case NAV_HOME:
+		return event;
+		default:
+		break;
+	}
+
+	ListView_MoveTo(&list, sel);
+	frame->cursor = list.cursor;
+	frame->top = list.top;
+
+	if(open)
+	{
+		item = &node->items[sel];
+		if(item->child)
+			Screen_Push(&menuScreen, item->child);
+		else
+			Screen_Push(&actionScreen, item);
+	}
+	return NAV_NONE;
+}
+
+/*********************************************************************
+* Function:  static void Menu_Render(void)
+*
+* Overview: menu screen render handler. Draws whatever changed since
+*			the last frame; an idle menu sends nothing to the display.
+*
+********************************************************************/
+static void Menu_Render(void)
+{
+	if(titleDirty)
+	{
+		oledPutROMString((ROM_STRING)node->title, 0, 0);
+		oledPutROMString((ROM_STRING)blankRow, 1, 0);
+		titleDirty = FALSE;
+	}
+
+	ListView_Render(&list);
+}
+
+/*********************************************************************
+* Function:  static void Action_ClearRows(void)
+*
+* Overview: blanks the list's rows across the full width of the
+*			display. The list inverts the cursor row out to the last
+*			column, which the 21 character rows of oledPutROMString()
+*			do not reach.
+*
+********************************************************************/
+static void Action_ClearRows(void)
+{
+	BYTE page, col;
+
+	for(page = LIST_FIRST_PAGE; page < LIST_FIRST_PAGE + LIST_ROWS; page++)
+	{
+		WriteCommand(0xB0 + page);
+		WriteCommand(0x00 + (OFFSET & 0x0F));
+		WriteCommand(0x10 + ((OFFSET >> 4) & 0x0F));
+		for(col = 0; col < SCREEN_HOR_SIZE; col++)
+			WriteData(0x00);
+	}
+}
+
+/*********************************************************************
+* Function:  static void Action_Enter(void)
+*
+* Overview: action screen enter handler, the screen shown for a leaf
+*			item
+*
+********************************************************************/
+static void Action_Enter(void)
+{
+	actionDirty = TRUE;
+}
+
+/*********************************************************************
+* Function:  static NAV_EVENT Action_HandleEvent(NAV_EVENT event)
+*
+* Output: NAV_BACK when the left pad (or a flip) leaves the screen,
+*		  NAV_HOME on a shake
+*
+********************************************************************/
+static NAV_EVENT Action_HandleEvent(NAV_EVENT event)
+{
+	if(event == NAV_BACK || event == NAV_HOME)
+		return event;
+	if(Input_LeftPad())
+		return NAV_BACK;
+
+	return NAV_NONE;
+}
+
+/*********************************************************************
+* Function:  static void Action_Render(void)
+*
+* Overview: action screen render handler, draws the screen once
+*
+********************************************************************/
+static void Action_Render(void)
+{
+	const rom MENU_ITEM *item;
+	char str[4];
+
+	if(!actionDirty)
+		return;
+
+	item = (const rom MENU_ITEM *)Screen_Top()->arg;
+	itoa(item->action, str);
+
+	Action_ClearRows();
+	oledPutROMString((ROM_STRING)"Action   was pressed ", 4, 0);
+	oledPutString((unsigned char *)str, 4, 40);
+	oledPutROMString((ROM_STRING)"      press left     ", 5, 0);
+	oledPutROMString((ROM_STRING)"      to go back     ", 6, 0);
+	actionDirty = FALSE;
+}
+
+/*********************************************************************
+* Function:  void Menu_Start(const rom MENU_NODE *root)
+*
+* PreCondition: Sched_Init(), Input_Init(), Gesture_Init() and
+*				NvStore_Init() have been called
+*
+* Input: root - top level menu
+*
+* Side Effects: resets the screen stack
+*
+* Overview: opens the menu tree at the root, on the root screen,
+*			and reopens the menus saved by Menu_Save() on top of it.
+*			Screen_Step() runs it from then on.
+*
+********************************************************************/
+void Menu_Start(const rom MENU_NODE *root)
+{
+	const rom MENU_NODE *open;
+	const rom MENU_ITEM *item;
+	WORD depth, view;
+	BYTE level;
+
+	Screen_Reset();
+
+	depth = NvStore_ReadDefault(NV_KEY_MENU_DEPTH, 0);
+	open = root;
+	for(level = 0; level < depth && level < NV_MENU_LEVELS; level++)
+	{
+		view = NvStore_ReadDefault(NV_KEY_MENU_VIEW + level, 0);
+		Screen_PushView(&menuScreen, open, view & 0xFF, view >> 8);
+
+		// the tree may have changed since the view was saved
+		if((view & 0xFF) >= open->count)
+			break;
+		item = &open->items[view & 0xFF];
+		if(item->child == NULL)
+			break;
+		open = item->child;
+	}
+
+	if(Screen_Depth() == 0)
+		Screen_Push(&menuScreen, root);
+}
+
+/*********************************************************************
+* Function:  void Menu_Save(void)
+*
+* Side Effects: writes to flash when the view changed since the last
+*				call
+*
+* Overview: saves the open menus and their views, for Menu_Start()
+*			after a reset. The action screen is not saved.
+*
+********************************************************************/
+void Menu_Save(void)
+{
+	SCREEN_FRAME *frame;
+	BYTE level;
+
+	for(level = 0; level < Screen_Depth() && level < NV_MENU_LEVELS; level++)
+	{
+		frame = Screen_Frame(level);
+		if(frame->screen != &menuScreen)
+			break;
+		NvStore_Write(NV_KEY_MENU_VIEW + level, frame->cursor | (frame->top << 8));
+	}
+	NvStore_Write(NV_KEY_MENU_DEPTH, level);
+}
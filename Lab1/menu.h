@@ -0,0 +1,76 @@
+/********************************************************************
+  File Information:
+    FileName:     	menu.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Menu engine. Every menu screen is a MENU_NODE in ROM: a title,
+    a list of items and the input method that moves the selection.
+    An item either opens a child node or, when it has none, shows
+    the action screen for its action ID. Adding a category is a new
+    table entry; the engine owns all the drawing and input handling.
+
+    Every open node is a menu screen on the screen stack (screen.h)
+    and leaf items open the action screen on top of it, so the menu
+    runs one frame per Screen_Step() and never blocks.
+
+    Screen layout: title on page 0, items in a list view on pages
+    2..7 (see listview.h) with the selection drawn inverted. Input
+    only changes the menu state and marks what it affects; the frame
+    then draws just the marked parts, so a menu nobody touches sends
+    nothing to the display. The pot and the tilt only move the
+    selection when they cross a band edge (see quantiser.h).
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef MENU_H
+#define MENU_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "nav.h"
+#include "sched.h"
+/*********************************************/
+
+// Frames without any input before the application may go to sleep
+#define MENU_IDLE_FRAMES		(30 * SCHED_FRAME_HZ)
+
+// How the selection is moved. The push button always opens the
+// selected item; the up pad goes back unless it scrolls; flipping the
+// board over always goes back and shaking it goes to the root.
+#define MENU_INPUT_POT			0			// absolute, pot position
+#define MENU_INPUT_TILT			1			// absolute, held X tilt
+#define MENU_INPUT_SCROLL		2			// up/down pads, forward/back tilt
+#define MENU_INPUT_SIDE			3			// left/right pads, left/right tilt
+
+// Node flags
+#define MENU_FLAG_RIGHT_OPENS	0x01		// right pad opens, like the button
+
+struct MENU_NODE_;
+
+typedef struct
+{
+	const rom char *label;					// padded to the display width
+	const rom struct MENU_NODE_ *child;		// NULL for a leaf
+	BYTE action;							// shown by the action screen
+} MENU_ITEM;
+
+typedef struct MENU_NODE_
+{
+	const rom char *title;
+	const rom MENU_ITEM *items;
+	BYTE count;
+	BYTE input;								// MENU_INPUT_xxx
+	BYTE flags;								// MENU_FLAG_xxx
+} MENU_NODE;
+
+void Menu_Start(const rom MENU_NODE *root);
+void Menu_Save(void);
+
+#endif
@@ -0,0 +1,34 @@
+/********************************************************************
+  File Information:
+    FileName:     	nav.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Navigation events shared by every input source (touch pads,
+    push button, accelerometer gestures). Screens react to these
+    instead of to the raw readings of a particular sensor.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef NAV_H
+#define NAV_H
+
+typedef enum
+{
+	NAV_NONE = 0,
+	NAV_UP,
+	NAV_DOWN,
+	NAV_LEFT,
+	NAV_RIGHT,
+	NAV_SELECT,
+	NAV_BACK,
+	NAV_HOME
+} NAV_EVENT;
+
+#endif
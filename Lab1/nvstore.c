@@ -0,0 +1,316 @@
+/********************************************************************
+  File Information:
+    FileName:     	nvstore.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Flash key/value store, see nvstore.h
+
+    Page layout:   WORD magic, WORD sequence, records...
+    Record layout: BYTE key, BYTE check, WORD value
+
+    The value word of a record is programmed before the key word, so
+    a record whose key is still erased was never committed. Of the
+    two pages the one with the magic and the newer sequence is used.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "nvstore.h"
+/*********************************************/
+
+#define NV_MAGIC				0x564E		// "NV"
+#define NV_HEADER_SIZE			4
+#define NV_RECORD_SIZE			4
+#define NV_CHECK_SEED			0x5A
+#define NV_ERASED				0xFF
+
+#define NvStore_Check(key, data)	((BYTE)((key) ^ (BYTE)(data) ^ (BYTE)((data) >> 8) ^ NV_CHECK_SEED))
+
+static WORD value[NV_KEYS];
+static BOOL known[NV_KEYS];
+static WORD activePage;						// 0 until the first write
+static WORD sequence;
+static WORD nextRecord;						// address of the first free record
+
+
+#if defined(__18CXX)
+
+/*********************************************************************
+* Function:  static BYTE NvStore_ReadByte(WORD address)
+*
+* Output: the program memory byte at the address
+*
+********************************************************************/
+static BYTE NvStore_ReadByte(WORD address)
+{
+	return *(const rom BYTE *)address;
+}
+
+/*********************************************************************
+* Function:  static void NvStore_Unlock(void)
+*
+* PreCondition: TBLPTR and EECON1 are set up for the operation
+*
+* Overview: runs the unlock sequence and starts the erase or write.
+*			The CPU stalls until it is done; interrupts are held off
+*			for the sequence and then restored.
+*
+********************************************************************/
+static void NvStore_Unlock(void)
+{
+	BYTE gie;
+
+	gie = INTCONbits.GIE;
+	INTCONbits.GIE = 0;
+	_asm
+	MOVLW 0x55
+	MOVWF EECON2, 0
+	MOVLW 0xAA
+	MOVWF EECON2, 0
+	BSF EECON1, 1, 0
+	_endasm
+
+	//Good practice now to clear the WREN bit, as further protection against any
+	//	 future accidental activation of self write/erase operations.
+	EECON1bits.WREN = 0;
+	INTCONbits.GIE = gie;
+}
+
+/*********************************************************************
+* Function:  static void NvStore_ErasePage(WORD page)
+*
+* Overview: erases one 1 KB flash block
+*
+********************************************************************/
+static void NvStore_ErasePage(WORD page)
+{
+	TBLPTRU = 0;
+	TBLPTRH = (BYTE)(page >> 8);
+	TBLPTRL = (BYTE)page;
+
+	EECON1 = 0b00010100;						// FREE, WREN
+	NvStore_Unlock();
+}
+
+/*********************************************************************
+* Function:  static void NvStore_WriteWord(WORD address, WORD data)
+*
+* Input: address - even address of an erased word
+*
+* Overview: programs one word
+*
+********************************************************************/
+static void NvStore_WriteWord(WORD address, WORD data)
+{
+	TBLPTRU = 0;
+	TBLPTRH = (BYTE)(address >> 8);
+	TBLPTRL = (BYTE)address;
+
+	TABLAT = (BYTE)data;
+	_asm
+	tblwtpostinc
+	_endasm
+	TABLAT = (BYTE)(data >> 8);
+	_asm
+	tblwt					//Do not increment TBLPTR on the second write.  See datasheet.
+	_endasm
+
+	EECON1 = 0b00100100;						// WPROG, WREN: word programming mode
+	NvStore_Unlock();
+}
+
+#else
+
+// Host build (sim/): the simulator models program flash
+#include "sim.h"
+
+#define NvStore_ReadByte(address)			Sim_FlashRead(address)
+#define NvStore_ErasePage(page)				Sim_FlashErase(page)
+#define NvStore_WriteWord(address, data)	Sim_FlashWrite(address, data)
+
+#endif
+
+/*********************************************************************
+* Function:  static WORD NvStore_ReadWord(WORD address)
+*
+* Output: the program memory word at the address
+*
+********************************************************************/
+static WORD NvStore_ReadWord(WORD address)
+{
+	return NvStore_ReadByte(address) | ((WORD)NvStore_ReadByte(address + 1) << 8);
+}
+
+/*********************************************************************
+* Function:  static void NvStore_Append(BYTE key)
+*
+* PreCondition: the active page has a free record
+*
+* Overview: appends the cached value of the key to the active page
+*
+********************************************************************/
+static void NvStore_Append(BYTE key)
+{
+	NvStore_WriteWord(nextRecord + 2, value[key]);
+	NvStore_WriteWord(nextRecord, key | ((WORD)NvStore_Check(key, value[key]) << 8));
+	nextRecord += NV_RECORD_SIZE;
+}
+
+/*********************************************************************
+* Function:  static void NvStore_Compact(void)
+*
+* Overview: writes the latest value of every key to the other page
+*			and makes it the active one
+*
+********************************************************************/
+static void NvStore_Compact(void)
+{
+	WORD page;
+	BYTE key;
+
+	page = (activePage == NV_PAGE_A) ? NV_PAGE_B : NV_PAGE_A;
+
+	NvStore_ErasePage(page);
+	nextRecord = page + NV_HEADER_SIZE;
+	for(key = 0; key < NV_KEYS; key++)
+		if(known[key])
+			NvStore_Append(key);
+
+	// the magic goes in last, the page is not valid without it
+	sequence++;
+	NvStore_WriteWord(page + 2, sequence);
+	NvStore_WriteWord(page, NV_MAGIC);
+	activePage = page;
+}
+
+/*********************************************************************
+* Function:  void NvStore_Init(void)
+*
+* Overview: finds the active page and loads the latest value of
+*			every key into RAM. Does not write to flash.
+*
+********************************************************************/
+void NvStore_Init(void)
+{
+	WORD address, end, data;
+	BYTE key, check;
+	BOOL validA, validB;
+
+	for(key = 0; key < NV_KEYS; key++)
+		known[key] = FALSE;
+
+	validA = NvStore_ReadWord(NV_PAGE_A) == NV_MAGIC;
+	validB = NvStore_ReadWord(NV_PAGE_B) == NV_MAGIC;
+
+	activePage = 0;
+	sequence = 0;
+	if(validA)
+	{
+		activePage = NV_PAGE_A;
+		sequence = NvStore_ReadWord(NV_PAGE_A + 2);
+	}
+	if(validB && (!validA || (SHORT)(NvStore_ReadWord(NV_PAGE_B + 2) - sequence) > 0))
+	{
+		activePage = NV_PAGE_B;
+		sequence = NvStore_ReadWord(NV_PAGE_B + 2);
+	}
+	if(activePage == 0)
+		return;
+
+	end = activePage + NV_PAGE_SIZE;
+	for(address = activePage + NV_HEADER_SIZE; address < end; address += NV_RECORD_SIZE)
+	{
+		key = NvStore_ReadByte(address);
+		check = NvStore_ReadByte(address + 1);
+		data = NvStore_ReadWord(address + 2);
+
+		if(key == NV_ERASED && check == NV_ERASED && data == 0xFFFF)
+			break;								// end of the records
+		if(key < NV_KEYS && check == NvStore_Check(key, data))
+		{
+			value[key] = data;
+			known[key] = TRUE;
+		}
+	}
+	nextRecord = address;
+}
+
+/*********************************************************************
+* Function:  BOOL NvStore_Read(BYTE key, WORD *data)
+*
+* Output: FALSE if the key was never written, data is then untouched
+*
+********************************************************************/
+BOOL NvStore_Read(BYTE key, WORD *data)
+{
+	if(key >= NV_KEYS || !known[key])
+		return FALSE;
+
+	*data = value[key];
+	return TRUE;
+}
+
+/*********************************************************************
+* Function:  WORD NvStore_ReadDefault(BYTE key, WORD data)
+*
+* Output: the stored value of the key, or the given default
+*
+********************************************************************/
+WORD NvStore_ReadDefault(BYTE key, WORD data)
+{
+	NvStore_Read(key, &data);
+	return data;
+}
+
+/*********************************************************************
+* Function:  void NvStore_Write(BYTE key, WORD data)
+*
+* Side Effects: stalls the CPU for the flash write, and for a page
+*				erase when the active page is full
+*
+* Overview: stores a value. Writing the value already stored costs
+*			nothing.
+*
+********************************************************************/
+void NvStore_Write(BYTE key, WORD data)
+{
+	if(key >= NV_KEYS || (known[key] && value[key] == data))
+		return;
+
+	value[key] = data;
+	known[key] = TRUE;
+
+	if(activePage == 0 || nextRecord >= activePage + NV_PAGE_SIZE)
+		NvStore_Compact();
+	else
+		NvStore_Append(key);
+}
+
+/*********************************************************************
+* Function:  void NvStore_Erase(void)
+*
+* Overview: forgets every key, for a cold start
+*
+********************************************************************/
+void NvStore_Erase(void)
+{
+	BYTE key;
+
+	NvStore_ErasePage(NV_PAGE_A);
+	NvStore_ErasePage(NV_PAGE_B);
+
+	for(key = 0; key < NV_KEYS; key++)
+		known[key] = FALSE;
+	activePage = 0;
+	sequence = 0;
+}
@@ -0,0 +1,57 @@
+/********************************************************************
+  File Information:
+    FileName:     	nvstore.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    UI state kept across resets in program flash (the part has no
+    data EEPROM). Values are WORDs under BYTE keys.
+
+    Two 1 KB erase pages are reserved at NV_PAGE_A/NV_PAGE_B (see
+    the nvstore CODEPAGE in the linker script). The active page holds
+    a header and then 4 byte records appended in order; the latest
+    record of a key wins, so a write never rewrites flash in place
+    and the wear spreads over the whole page. When the page is full
+    the latest value of every key is copied to the other page, whose
+    header is written last: a reset during compaction leaves the old
+    page active.
+
+    Every write stalls the CPU for the flash programming time with
+    interrupts off, so callers write on state changes, not per frame.
+
+    The SD bootloader erases both pages after loading an image
+    (LOADER_CLEAR_BASE in its boot_config.h), so new firmware never
+    restores a menu view saved by the old one.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef NVSTORE_H
+#define NVSTORE_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+/*********************************************/
+
+#define NV_PAGE_A				0xF400
+#define NV_PAGE_B				0xF800
+#define NV_PAGE_SIZE			1024		// flash erase block
+
+// Keys
+#define NV_KEY_MENU_DEPTH		0			// menu screens open
+#define NV_KEY_MENU_VIEW		1			// + level: cursor | top << 8
+#define NV_MENU_LEVELS			8
+#define NV_KEYS					(NV_KEY_MENU_VIEW + NV_MENU_LEVELS)
+
+void NvStore_Init(void);
+BOOL NvStore_Read(BYTE key, WORD *data);
+WORD NvStore_ReadDefault(BYTE key, WORD data);
+void NvStore_Write(BYTE key, WORD data);
+void NvStore_Erase(void);
+
+#endif
@@ -0,0 +1,108 @@
+/********************************************************************
+  File Information:
+    FileName:     	quantiser.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Table driven band quantiser with hysteresis, see quantiser.h
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "quantiser.h"
+/*********************************************/
+
+
+/*********************************************************************
+* Function:  void Quantiser_Init(QUANTISER *q, BYTE items,
+*								 WORD fullScale, WORD hysteresis)
+*
+* PreCondition: none
+*
+* Input: q          - quantiser to set up
+*		 items      - number of menu items (1..QUANT_MAX_ITEMS)
+*		 fullScale  - largest value the input can take
+*		 hysteresis - distance the input must move past a band edge
+*					  before the selection changes
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: splits 0..fullScale into equal, gap free bands and selects
+*			band 0
+*
+********************************************************************/
+void Quantiser_Init(QUANTISER *q, BYTE items, WORD fullScale, WORD hysteresis)
+{
+	BYTE i;
+
+	if(items == 0)
+		items = 1;
+	if(items > QUANT_MAX_ITEMS)
+		items = QUANT_MAX_ITEMS;
+
+	q->items = items;
+	q->hysteresis = hysteresis;
+	q->index = 0;
+
+	for(i = 0; i < items; i++)
+		q->bound[i] = (WORD)(((DWORD)fullScale + 1) * i / items);
+	q->bound[items] = 0xFFFF;
+}
+
+/*********************************************************************
+* Function:  BYTE Quantiser_Update(QUANTISER *q, WORD value)
+*
+* PreCondition: Quantiser_Init() has been called
+*
+* Input: q     - quantiser
+*		 value - new input reading
+*
+* Output: index of the selected band, 0..items-1
+*
+* Side Effects: none
+*
+* Overview: keeps the current band while the reading stays within it
+*			widened by the hysteresis, otherwise looks the reading up
+*			in the band table
+*
+********************************************************************/
+BYTE Quantiser_Update(QUANTISER *q, WORD value)
+{
+	BYTE i;
+	WORD low, high;
+
+	low = q->bound[q->index];
+	high = q->bound[q->index + 1];
+
+	if(low > q->hysteresis)
+		low -= q->hysteresis;
+	else
+		low = 0;
+
+	if(high < 0xFFFF - q->hysteresis)
+		high += q->hysteresis;
+	else
+		high = 0xFFFF;
+
+	if(value >= low && value < high)
+		return q->index;
+
+	for(i = q->items - 1; i > 0; i--)
+	{
+		if(value >= q->bound[i])
+			break;
+	}
+	q->index = i;
+
+	return i;
+}
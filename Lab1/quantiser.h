@@ -0,0 +1,42 @@
+/********************************************************************
+  File Information:
+    FileName:     	quantiser.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Maps an analog reading (potentiometer, tilt, ...) onto the items
+    of an N-item menu. Band edges are computed once by Quantiser_Init()
+    and a hysteresis window around the current band keeps the
+    selection from flickering when the input sits on an edge.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef QUANTISER_H
+#define QUANTISER_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+/*********************************************/
+
+#define QUANT_MAX_ITEMS		8
+
+typedef struct
+{
+	BYTE items;								// number of bands
+	WORD hysteresis;						// extra travel needed to leave a band
+	WORD bound[QUANT_MAX_ITEMS + 1];		// band i is bound[i] <= value < bound[i+1]
+	BYTE index;								// current (stable) band
+} QUANTISER;
+
+void Quantiser_Init(QUANTISER *q, BYTE items, WORD fullScale, WORD hysteresis);
+BYTE Quantiser_Update(QUANTISER *q, WORD value);
+
+#define Quantiser_Index(q)		((q)->index)
+
+#endif
@@ -0,0 +1,229 @@
+/********************************************************************
+  File Information:
+    FileName:     	sched.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Cooperative tick scheduler, see sched.h
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "sched.h"
+/*********************************************/
+
+// Fosc/4 = 12 MHz, 1:16 prescale, 1:3 postscale, PR2 + 1 = 250 -> 1 kHz
+#define SCHED_T2CON				0b00010110
+#define SCHED_PR2				249
+
+static volatile WORD ticks;
+
+static const rom SCHED_TASK *tasks;
+static BYTE taskCount;
+static WORD taskDue[SCHED_MAX_TASKS];
+static BYTE taskOverruns[SCHED_MAX_TASKS];
+
+static WORD frameDue;
+static BYTE frameOverruns;
+static WORD frameCount;
+
+
+/*********************************************************************
+* Function:  static WORD Sched_NextDue(WORD due, WORD period,
+*									   WORD now, BYTE *overruns)
+*
+* Overview: advances a deadline by one period, or restarts it from
+*			now (and counts an overrun) if a whole period was missed
+*
+********************************************************************/
+static WORD Sched_NextDue(WORD due, WORD period, WORD now, BYTE *overruns)
+{
+	due += period;
+	if(SCHED_DUE(now, due))
+	{
+		if(*overruns != 0xFF)
+			(*overruns)++;
+		due = now + period;
+	}
+	return due;
+}
+
+/*********************************************************************
+* Function:  void Sched_Init(const rom SCHED_TASK *table, BYTE count)
+*
+* PreCondition: none
+*
+* Input: table - task table, in priority order
+*		 count - entries in table, at most SCHED_MAX_TASKS
+*
+* Output: none
+*
+* Side Effects: takes Timer2, enables its interrupt and global
+*				interrupts
+*
+* Overview: starts the tick. Every task is due on the first
+*			Sched_Service().
+*
+********************************************************************/
+void Sched_Init(const rom SCHED_TASK *table, BYTE count)
+{
+	BYTE i;
+
+	if(count > SCHED_MAX_TASKS)
+		count = SCHED_MAX_TASKS;
+
+	tasks = table;
+	taskCount = count;
+
+	PIE1bits.TMR2IE = 0;
+	ticks = 0;
+	for(i = 0; i < count; i++)
+	{
+		taskDue[i] = 0;
+		taskOverruns[i] = 0;
+	}
+	frameDue = 0;
+	frameOverruns = 0;
+	frameCount = 0;
+
+	T2CON = SCHED_T2CON & ~0x04;				// configure stopped
+	TMR2 = 0;
+	PR2 = SCHED_PR2;
+	PIR1bits.TMR2IF = 0;
+	PIE1bits.TMR2IE = 1;
+	RCONbits.IPEN = 0;
+	INTCONbits.PEIE = 1;
+	INTCONbits.GIE = 1;
+	T2CONbits.TMR2ON = 1;
+}
+
+/*********************************************************************
+* Function:  void Sched_ISR(void)
+*
+* PreCondition: PIR1bits.TMR2IF is set
+*
+* Overview: advances the tick
+*
+********************************************************************/
+void Sched_ISR(void)
+{
+	PIR1bits.TMR2IF = 0;
+	ticks++;
+}
+
+/*********************************************************************
+* Function:  WORD Sched_Ticks(void)
+*
+* Output: milliseconds since Sched_Init(), wrapping at 65536
+*
+********************************************************************/
+WORD Sched_Ticks(void)
+{
+	WORD now;
+
+	PIE1bits.TMR2IE = 0;
+	now = ticks;
+	PIE1bits.TMR2IE = 1;
+
+	return now;
+}
+
+/*********************************************************************
+* Function:  void Sched_Service(void)
+*
+* PreCondition: Sched_Init() has been called
+*
+* Overview: runs every task whose deadline has passed, each at most
+*			once, in table order
+*
+********************************************************************/
+void Sched_Service(void)
+{
+	BYTE i;
+	WORD now;
+
+	for(i = 0; i < taskCount; i++)
+	{
+		now = Sched_Ticks();
+		if(!SCHED_DUE(now, taskDue[i]))
+			continue;
+
+		tasks[i].task();
+
+		taskDue[i] = Sched_NextDue(taskDue[i], tasks[i].period, now, &taskOverruns[i]);
+	}
+}
+
+/*********************************************************************
+* Function:  void Sched_WaitFrame(void)
+*
+* PreCondition: Sched_Init() has been called
+*
+* Overview: services the tasks and idles until the next display
+*			frame is due. Called at the top of every UI loop.
+*
+* Note: the CPU sits in Idle mode between interrupts, so the A/D
+*		schedule and the tick keep running
+*
+********************************************************************/
+void Sched_WaitFrame(void)
+{
+	for(;;)
+	{
+		Sched_Service();
+		if(SCHED_DUE(Sched_Ticks(), frameDue))
+			break;
+
+		OSCCONbits.IDLEN = 1;
+		Sleep();
+		Nop();
+	}
+
+	frameDue = Sched_NextDue(frameDue, SCHED_FRAME_PERIOD, Sched_Ticks(), &frameOverruns);
+	frameCount++;
+}
+
+/*********************************************************************
+* Function:  BYTE Sched_TaskOverruns(BYTE task)
+*
+* Input: task - index into the table given to Sched_Init()
+*
+* Output: deadlines the task has missed, saturating at 255
+*
+********************************************************************/
+BYTE Sched_TaskOverruns(BYTE task)
+{
+	return taskOverruns[task];
+}
+
+/*********************************************************************
+* Function:  BYTE Sched_FrameOverruns(void)
+*
+* Output: display frames that started a whole frame late,
+*		  saturating at 255
+*
+********************************************************************/
+BYTE Sched_FrameOverruns(void)
+{
+	return frameOverruns;
+}
+
+/*********************************************************************
+* Function:  WORD Sched_FrameCount(void)
+*
+* Output: frames released by Sched_WaitFrame() since Sched_Init()
+*
+********************************************************************/
+WORD Sched_FrameCount(void)
+{
+	return frameCount;
+}
@@ -0,0 +1,60 @@
+/********************************************************************
+  File Information:
+    FileName:     	sched.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Cooperative scheduler on a 1 kHz Timer2 tick. The application
+    hands Sched_Init() a ROM table of short, non-blocking tasks and
+    their periods. Tasks run from Sched_Service(); the UI loops call
+    Sched_WaitFrame() once per redraw, which keeps the tasks running,
+    idles the CPU in the slack and releases the next frame at
+    SCHED_FRAME_HZ.
+
+    A task (or a frame) that starts a whole period or more after its
+    deadline counts as an overrun. It is rescheduled from now rather
+    than run several times to catch up.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef SCHED_H
+#define SCHED_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+/*********************************************/
+
+#define SCHED_TICK_HZ			1000
+#define SCHED_FRAME_HZ			30
+#define SCHED_MAX_TASKS			8
+
+// Converts milliseconds to ticks at compile time
+#define SCHED_MS(ms)			((WORD)(((DWORD)(ms) * SCHED_TICK_HZ) / 1000))
+#define SCHED_FRAME_PERIOD		((WORD)(SCHED_TICK_HZ / SCHED_FRAME_HZ))
+
+// TRUE once now has reached due, valid across tick counter wrap
+#define SCHED_DUE(now, due)		((SHORT)((now) - (due)) >= 0)
+
+typedef struct
+{
+	void (*task)(void);
+	WORD period;							// ticks
+} SCHED_TASK;
+
+void Sched_Init(const rom SCHED_TASK *table, BYTE count);
+void Sched_ISR(void);
+WORD Sched_Ticks(void);
+void Sched_Service(void);
+void Sched_WaitFrame(void);
+
+BYTE Sched_TaskOverruns(BYTE task);
+BYTE Sched_FrameOverruns(void);
+WORD Sched_FrameCount(void);
+
+#endif
@@ -0,0 +1,216 @@
+/********************************************************************
+  File Information:
+    FileName:     	screen.c
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Screen stack, see screen.h
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "screen.h"
+/*********************************************/
+
+static SCREEN_FRAME stack[SCREEN_STACK_DEPTH];
+static BYTE depth;
+static WORD idleFrames;
+
+
+/*********************************************************************
+* Function:  static void Screen_Enter(void)
+*
+* Overview: tells the top screen it is being shown
+*
+********************************************************************/
+static void Screen_Enter(void)
+{
+	if(stack[depth - 1].screen->enter)
+		stack[depth - 1].screen->enter();
+}
+
+/*********************************************************************
+* Function:  static void Screen_Close(void)
+*
+* Overview: drops the top screen without showing the one below
+*
+********************************************************************/
+static void Screen_Close(void)
+{
+	if(stack[depth - 1].screen->exit)
+		stack[depth - 1].screen->exit();
+	depth--;
+}
+
+/*********************************************************************
+* Function:  void Screen_Reset(void)
+*
+* Side Effects: the open screens are dropped without their exit()
+*
+* Overview: empties the stack; push the root screen next
+*
+********************************************************************/
+void Screen_Reset(void)
+{
+	depth = 0;
+	idleFrames = 0;
+}
+
+/*********************************************************************
+* Function:  BOOL Screen_Push(const rom SCREEN *screen,
+*							  const rom void *arg)
+*
+* Output: FALSE if the stack is full and the screen was not opened
+*
+* Overview: opens a screen on top of the current one
+*
+********************************************************************/
+BOOL Screen_Push(const rom SCREEN *screen, const rom void *arg)
+{
+	return Screen_PushView(screen, arg, SCREEN_NEW_VIEW, 0);
+}
+
+/*********************************************************************
+* Function:  BOOL Screen_PushView(const rom SCREEN *screen,
+*								  const rom void *arg,
+*								  WORD cursor, WORD top)
+*
+* Output: FALSE if the stack is full and the screen was not opened
+*
+* Overview: opens a screen with a saved view, as if going back to it
+*
+********************************************************************/
+BOOL Screen_PushView(const rom SCREEN *screen, const rom void *arg, WORD cursor, WORD top)
+{
+	if(depth == SCREEN_STACK_DEPTH)
+		return FALSE;
+
+	stack[depth].screen = screen;
+	stack[depth].arg = arg;
+	stack[depth].cursor = cursor;
+	stack[depth].top = top;
+	depth++;
+
+	Screen_Enter();
+	return TRUE;
+}
+
+/*********************************************************************
+* Function:  void Screen_Pop(void)
+*
+* Overview: closes the top screen and shows the one below it. The
+*			root screen is never closed.
+*
+********************************************************************/
+void Screen_Pop(void)
+{
+	if(depth <= 1)
+		return;
+
+	Screen_Close();
+	Screen_Enter();
+}
+
+/*********************************************************************
+* Function:  SCREEN_FRAME *Screen_Top(void)
+*
+* Output: the frame of the screen being shown
+*
+********************************************************************/
+SCREEN_FRAME *Screen_Top(void)
+{
+	return &stack[depth - 1];
+}
+
+/*********************************************************************
+* Function:  BYTE Screen_Depth(void)
+*
+* Output: number of open screens
+*
+********************************************************************/
+BYTE Screen_Depth(void)
+{
+	return depth;
+}
+
+/*********************************************************************
+* Function:  SCREEN_FRAME *Screen_Frame(BYTE level)
+*
+* Input: level - 0 for the root screen, up to Screen_Depth() - 1
+*
+* Output: the frame of an open screen
+*
+********************************************************************/
+SCREEN_FRAME *Screen_Frame(BYTE level)
+{
+	return &stack[level];
+}
+
+/*********************************************************************
+* Function:  NAV_EVENT Screen_Step(NAV_EVENT event)
+*
+* PreCondition: a root screen has been pushed
+*
+* Input: event - this frame's navigation event
+*
+* Output: NAV_HOME if the root screen left it to the stack,
+*		  NAV_NONE otherwise
+*
+* Overview: runs one frame of the top screen
+*
+********************************************************************/
+NAV_EVENT Screen_Step(NAV_EVENT event)
+{
+	NAV_EVENT left;
+	BYTE oldDepth;
+	WORD oldCursor;
+
+	oldDepth = depth;
+	oldCursor = stack[depth - 1].cursor;
+
+	left = stack[depth - 1].screen->handleEvent(event);
+
+	if(left == NAV_BACK)
+		Screen_Pop();
+	else if(left == NAV_HOME && depth > 1)
+	{
+		while(depth > 1)
+			Screen_Close();
+		Screen_Enter();
+		left = NAV_NONE;
+	}
+
+	stack[depth - 1].screen->render();
+
+	if(event == NAV_NONE && depth == oldDepth && stack[depth - 1].cursor == oldCursor)
+		idleFrames++;
+	else
+		idleFrames = 0;
+
+	return left == NAV_HOME ? NAV_HOME : NAV_NONE;
+}
+
+/*********************************************************************
+* Function:  BOOL Screen_Idle(WORD frames)
+*
+* Output: TRUE, once, when Screen_Step() has seen no input for the
+*		  given number of frames
+*
+********************************************************************/
+BOOL Screen_Idle(WORD frames)
+{
+	if(idleFrames < frames)
+		return FALSE;
+
+	idleFrames = 0;
+	return TRUE;
+}
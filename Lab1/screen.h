@@ -0,0 +1,70 @@
+/********************************************************************
+  File Information:
+    FileName:     	screen.h
+    Dependencies:   See INCLUDES section
+    Processor:      PIC18F46J50
+    Hardware:       PIC18F Starter Kit
+    Complier:  	    Microchip C18 (for PIC18)
+
+  File Description:
+    Screen stack. Every screen is a SCREEN in ROM holding its
+    handlers; the stack holds the open screens, the top one being
+    shown. The main loop calls Screen_Step() once per frame, so no
+    screen ever blocks and the scheduler tasks run on every screen.
+
+    Per frame the top screen gets handleEvent() with the frame's
+    navigation event and then render(). handleEvent() may push a
+    screen, and returns the events it leaves to the stack:
+    NAV_BACK pops the top screen, NAV_HOME pops back to the root.
+    enter() runs whenever a screen becomes the top one, whether it
+    was pushed or uncovered; exit() runs when it is popped.
+
+    Each open screen keeps its view (cursor and scroll offset) in its
+    stack record, so going back restores the view exactly as it was
+    left, at any depth. A pushed screen starts with SCREEN_NEW_VIEW
+    as its cursor and picks its own starting view.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef SCREEN_H
+#define SCREEN_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "nav.h"
+/*********************************************/
+
+#define SCREEN_STACK_DEPTH		8
+
+#define SCREEN_NEW_VIEW			0xFFFF		// cursor of a screen just pushed
+
+typedef struct
+{
+	void (*enter)(void);					// may be NULL
+	NAV_EVENT (*handleEvent)(NAV_EVENT event);
+	void (*render)(void);
+	void (*exit)(void);						// may be NULL
+} SCREEN;
+
+typedef struct
+{
+	const rom SCREEN *screen;
+	const rom void *arg;					// what the screen shows
+	WORD cursor;							// selection, kept while covered
+	WORD top;								// first item shown, ditto
+} SCREEN_FRAME;
+
+void Screen_Reset(void);
+BOOL Screen_Push(const rom SCREEN *screen, const rom void *arg);
+BOOL Screen_PushView(const rom SCREEN *screen, const rom void *arg, WORD cursor, WORD top);
+void Screen_Pop(void);
+SCREEN_FRAME *Screen_Top(void);
+BYTE Screen_Depth(void);
+SCREEN_FRAME *Screen_Frame(BYTE level);
+NAV_EVENT Screen_Step(NAV_EVENT event);
+BOOL Screen_Idle(WORD frames);
+
+#endif
@@ -0,0 +1,44 @@
+/********************************************************************
+  File Information:
+    FileName:     	BMA150.h
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    BMA150 driver interface used by Lab1. InitBma150() resets the
+    simulated part (sim_bma150.c); the registers are reached through
+    the modelled MSSP2 like on the board.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef BMA150_H
+#define BMA150_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+/*********************************************/
+
+#define BMA150_CHIP_ID			0x00
+#define BMA150_ACC_X_LSB		0x02
+#define BMA150_ACC_X_MSB		0x03
+#define BMA150_ACC_Y_LSB		0x04
+#define BMA150_ACC_Y_MSB		0x05
+#define BMA150_ACC_Z_LSB		0x06
+#define BMA150_ACC_Z_MSB		0x07
+#define BMA150_TEMP				0x08
+
+typedef struct
+{
+	SHORT x;
+	SHORT y;
+	SHORT z;
+} BMA150_XYZ;
+
+void InitBma150(void);
+
+#endif
@@ -0,0 +1,45 @@
+/********************************************************************
+  File Information:
+    FileName:     	Compiler.h
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    Host stand-in for the Microchip header of the same name. The C18
+    storage qualifiers go away (ROM data stays const), the register
+    file comes from the simulator's p18cxxx.h and Sleep() hands the
+    CPU to the simulator, which is where virtual time passes.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef COMPILER_H
+#define COMPILER_H
+
+/******** Include files **********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "p18cxxx.h"
+/*********************************************/
+
+#define rom
+#define ROM						const
+#define far
+#define near
+
+#define Nop()					((void)0)
+#define ClrWdt()				((void)0)
+#define Reset()					exit(1)
+#define Sleep()					Sim_Sleep()
+
+void Sim_Sleep(void);
+
+// C18 library call missing from the host C library
+char *itoa(int value, char *string);
+
+#endif
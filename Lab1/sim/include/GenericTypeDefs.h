@@ -0,0 +1,43 @@
+/********************************************************************
+  File Information:
+    FileName:     	GenericTypeDefs.h
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    Host stand-in for the Microchip header of the same name, with
+    the C18 sizes: WORD and SHORT are 16 bit, DWORD and LONG 32 bit.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef GENERIC_TYPE_DEFS_H
+#define GENERIC_TYPE_DEFS_H
+
+/******** Include files **********************/
+#include <stddef.h>
+#include <stdint.h>
+/*********************************************/
+
+typedef enum _BOOL { FALSE = 0, TRUE } BOOL;
+
+typedef uint8_t			BYTE;
+typedef uint16_t		WORD;
+typedef uint32_t		DWORD;
+typedef uint64_t		QWORD;
+typedef int8_t			CHAR;
+typedef int16_t			SHORT;
+typedef int32_t			LONG;
+
+typedef uint8_t			UINT8;
+typedef uint16_t		UINT16;
+typedef uint32_t		UINT32;
+typedef int8_t			INT8;
+typedef int16_t			INT16;
+typedef int32_t			INT32;
+
+#endif
@@ -0,0 +1,23 @@
+/********************************************************************
+  File Information:
+    FileName:     	HardwareProfile.h
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    Board selection for the simulator build: the PIC18F Starter Kit
+    (PIC18F46J50), as in the firmware build.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef HARDWARE_PROFILE_H
+#define HARDWARE_PROFILE_H
+
+#define PIC18F46J50_PIM
+
+#endif
@@ -0,0 +1,28 @@
+/********************************************************************
+  File Information:
+    FileName:     	mtouch.h
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    mTouch library calls used by Lab1. The pads themselves are read
+    through the A/D scheduler, which the simulator models directly.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef MTOUCH_H
+#define MTOUCH_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+/*********************************************/
+
+void mTouchInit(void);
+void mTouchCalibrate(void);
+
+#endif
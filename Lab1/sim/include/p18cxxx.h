@@ -0,0 +1,127 @@
+/********************************************************************
+  File Information:
+    FileName:     	p18cxxx.h
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    The PIC18F46J50 special function registers Lab1 and the OLED
+    driver use, as plain variables (sim_hw.c). A register and its
+    ...bits view share storage like on the part; bit positions are
+    the datasheet ones.
+
+    A few registers go through an access function instead, so the
+    peripheral models see the firmware use them:
+
+      LATEbits      OLED bus strobes (sim_oled.c)
+      LATCbits      BMA150 chip select (sim_bma150.c)
+      SSP2STATbits  polling BF clocks the byte in SSP2BUF
+      PIR3bits      polling TX2IF sends the byte in TXREG2
+      TXREG2
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef P18CXXX_H
+#define P18CXXX_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+/*********************************************/
+
+#define SIM_BITS8(p)	struct { unsigned p##0:1, p##1:1, p##2:1, p##3:1, p##4:1, p##5:1, p##6:1, p##7:1; }
+
+#define SIM_SFR(name, ...) \
+	typedef union { volatile BYTE byte; __VA_ARGS__ bits; } name##_SFR; \
+	extern name##_SFR sim##name;
+
+// Plain registers
+extern volatile BYTE ADCON1, ANCON0, ANCON1, CCP2CON, CCPR2H, CCPR2L, EECON2, PR2,
+					 RPINR1, RPOR11, SPBRG2, SPBRGH2, SSP2BUF, TMR1H, TMR1L, TMR2,
+					 TXSTA2, TABLAT, TBLPTRU, TBLPTRH, TBLPTRL, PORTD;
+extern volatile WORD ADRES;
+
+// Registers with bit fields
+SIM_SFR(ADCON0,   struct { unsigned ADON:1, GO:1, CHS:4, VCFG0:1, VCFG1:1; })
+SIM_SFR(BAUDCON2, struct { unsigned ABDEN:1, WUE:1, :1, BRG16:1, TXCKP:1, RXDTP:1, RCIDL:1, ABDOVF:1; })
+SIM_SFR(CTMUCONH, struct { unsigned CTTRIG:1, IDISSEN:1, EDGSEQEN:1, EDGEN:1, TGEN:1, CTMUSIDL:1, :1, CTMUEN:1; })
+SIM_SFR(CTMUCONL, struct { unsigned EDG1STAT:1, EDG2STAT:1, EDG1SEL:2, EDG1POL:1, EDG2SEL:2, EDG2POL:1; })
+SIM_SFR(EECON1,   struct { unsigned :1, WR:1, WREN:1, WRERR:1, FREE:1, WPROG:1, :2; })
+SIM_SFR(INTCON,   struct { unsigned RBIF:1, INT0IF:1, TMR0IF:1, RBIE:1, INT0IE:1, TMR0IE:1, PEIE:1, GIE:1; })
+SIM_SFR(INTCON2,  struct { unsigned RBIP:1, INT3IP:1, TMR0IP:1, INTEDG3:1, INTEDG2:1, INTEDG1:1, INTEDG0:1, RBPU:1; })
+SIM_SFR(INTCON3,  struct { unsigned INT1IF:1, INT2IF:1, INT3IF:1, INT1IE:1, INT2IE:1, INT3IE:1, INT1IP:1, INT2IP:1; })
+SIM_SFR(OSCCON,   struct { unsigned SCS:2, :1, OSTS:1, IRCF:3, IDLEN:1; })
+SIM_SFR(PIE1,     struct { unsigned TMR1IE:1, TMR2IE:1, CCP1IE:1, SSP1IE:1, TX1IE:1, RC1IE:1, ADIE:1, PMPIE:1; })
+SIM_SFR(PIR1,     struct { unsigned TMR1IF:1, TMR2IF:1, CCP1IF:1, SSP1IF:1, TX1IF:1, RC1IF:1, ADIF:1, PMPIF:1; })
+SIM_SFR(PIR3,     struct { unsigned RTCCIF:1, TMR3GIF:1, CTMUIF:1, TMR4IF:1, TX2IF:1, RC2IF:1, BCL2IF:1, SSP2IF:1; })
+SIM_SFR(PPSCON,   struct { unsigned IOLOCK:1, :7; })
+SIM_SFR(RCON,     struct { unsigned BOR:1, POR:1, PD:1, TO:1, RI:1, CM:1, :1, IPEN:1; })
+SIM_SFR(RCSTA2,   struct { unsigned RX9D:1, OERR:1, FERR:1, ADDEN:1, CREN:1, SREN:1, RX9:1, SPEN:1; })
+SIM_SFR(SSP2STAT, struct { unsigned BF:1, UA:1, R_W:1, S:1, P:1, D_A:1, CKE:1, SMP:1; })
+SIM_SFR(T1CON,    struct { unsigned TMR1ON:1, RD16:1, T1SYNC:1, T1OSCEN:1, T1CKPS:2, TMR1CS:2; })
+SIM_SFR(T2CON,    struct { unsigned T2CKPS:2, TMR2ON:1, T2OUTPS:4, :1; })
+SIM_SFR(WDTCON,   struct { unsigned SWDTEN:1, :7; })
+SIM_SFR(TXREG2,   struct { unsigned TX:8; })
+SIM_SFR(PORTB,    SIM_BITS8(RB))
+SIM_SFR(LATB,     SIM_BITS8(LATB))
+SIM_SFR(TRISB,    SIM_BITS8(TRISB))
+SIM_SFR(PORTC,    SIM_BITS8(RC))
+SIM_SFR(LATC,     SIM_BITS8(LATC))
+SIM_SFR(TRISC,    SIM_BITS8(TRISC))
+SIM_SFR(LATD,     SIM_BITS8(LATD))
+SIM_SFR(TRISD,    SIM_BITS8(TRISD))
+SIM_SFR(LATE,     SIM_BITS8(LATE))
+SIM_SFR(TRISE,    SIM_BITS8(TRISE))
+
+#define ADCON0			simADCON0.byte
+#define ADCON0bits		simADCON0.bits
+#define BAUDCON2bits	simBAUDCON2.bits
+#define CTMUCONHbits	simCTMUCONH.bits
+#define CTMUCONLbits	simCTMUCONL.bits
+#define EECON1			simEECON1.byte
+#define EECON1bits		simEECON1.bits
+#define INTCON			simINTCON.byte
+#define INTCONbits		simINTCON.bits
+#define INTCON2bits		simINTCON2.bits
+#define INTCON3bits		simINTCON3.bits
+#define OSCCONbits		simOSCCON.bits
+#define PIE1bits		simPIE1.bits
+#define PIR1bits		simPIR1.bits
+#define PPSCONbits		simPPSCON.bits
+#define RCONbits		simRCON.bits
+#define RCSTA2			simRCSTA2.byte
+#define RCSTA2bits		simRCSTA2.bits
+#define T1CON			simT1CON.byte
+#define T1CONbits		simT1CON.bits
+#define T2CON			simT2CON.byte
+#define T2CONbits		simT2CON.bits
+#define PORTBbits		simPORTB.bits
+#define LATBbits		simLATB.bits
+#define TRISBbits		simTRISB.bits
+#define PORTCbits		simPORTC.bits
+#define TRISCbits		simTRISC.bits
+#define LATD			simLATD.byte
+#define LATDbits		simLATD.bits
+#define TRISD			simTRISD.byte
+#define TRISDbits		simTRISD.bits
+#define TRISEbits		simTRISE.bits
+#define WDTCONbits		simWDTCON.bits
+
+// Registers the peripheral models watch
+#define LATEbits		(Sim_LATE()->bits)
+#define LATCbits		(Sim_LATC()->bits)
+#define SSP2STATbits	(Sim_SSP2STAT()->bits)
+#define PIR3bits		(Sim_PIR3()->bits)
+#define TXREG2			(Sim_TXREG2()->byte)
+
+LATE_SFR *Sim_LATE(void);
+LATC_SFR *Sim_LATC(void);
+SSP2STAT_SFR *Sim_SSP2STAT(void);
+PIR3_SFR *Sim_PIR3(void);
+TXREG2_SFR *Sim_TXREG2(void);
+
+#endif
@@ -0,0 +1,26 @@
+/********************************************************************
+  File Information:
+    FileName:     	soft_start.h
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    APP_VDD soft start; the simulated supply is always up.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef SOFT_START_H
+#define SOFT_START_H
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+/*********************************************/
+
+#define AppPowerReady()			TRUE
+
+#endif
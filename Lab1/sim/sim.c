@@ -0,0 +1,776 @@
+/********************************************************************
+  File Information:
+    FileName:     	sim.c
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    Host simulator for the Lab1 menu application. The firmware
+    sources (main.c, the menus, scheduler, input and the OLED driver)
+    are built unchanged against the stand-in headers in include/;
+    this file runs them in virtual time and feeds them a script.
+
+    Usage: lab1sim [-v] [-a] [-r count] [-f flash.bin] script
+
+      -v   one line per frame: bus bytes, interrupts, estimated
+           cycles and, for the first redraw after an input, latency
+      -a   print the panel after every frame that changed it
+      -r   run the script count times back to back (load tests)
+      -f   load the program flash image before the run and save it
+           afterwards, so the nvstore pages survive between runs
+
+    Script, one command per line, '#' starts a comment:
+
+      wait <ms>                 let the firmware run
+      pot <0..1023>             potentiometer (AN4) conversion result
+      pad <right|up|down|left> <0..1023>   touch pad conversion result
+      touch <right|up|down|left>           touch a pad (SIM_PAD_xxx levels)
+      release                   no pad touched
+      button <0|1>              RB0 level, 0 is pressed
+      click                     press and release the button
+      accel <x> <y> <z>         acceleration in milli-g
+      shake                     shake along X, then rest flat
+      dump [file.pbm]           print the panel, or save it as a PBM
+      echo <text>               print the text
+
+    The script starts before the firmware does, so commands ahead of
+    the first wait set the state the board powers up in. The run ends
+    with the script, with a summary of the frames on stdout.
+
+    Interrupts are dispatched in the order YourHighPriorityISRCode()
+    in main.c checks them; that routine is only built for C18.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include <time.h>
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "adc_sched.h"
+#include "accel.h"
+#include "sched.h"
+#include "sim.h"
+/*********************************************/
+
+#define SIM_PAD_IDLE			900			// no pad fires, see input.h
+#define SIM_PAD_SIDE			700			// <= SIDE_PRESSED_LEVEL
+#define SIM_PAD_DOWN			1000		// > SCROLL_DOWN_LEVEL
+#define SIM_PAD_UP				990			// > SCROLL_UP_LEVEL,
+#define SIM_PAD_UP_DOWN			978			// with the down pad in its up band
+
+#define SIM_CLICK_MS			60			// > BUTTON_DEBOUNCE_TICKS touch task periods
+#define SIM_SHAKE_MG			1500
+#define SIM_SHAKE_MS			80
+#define SIM_SHAKE_SWINGS		6
+
+#define SIM_FRAME_CYCLES		(12000000UL / SCHED_FRAME_HZ)
+#define SIM_LATENCY_TIMEOUT_US	1000000		// an input without a redraw by then had none
+
+#define SIM_PAD_RIGHT			0			// A/D channels, mTouchReadButton() order
+#define SIM_PAD_UP_CH			1
+#define SIM_PAD_DOWN_CH			2
+#define SIM_PAD_LEFT			3
+
+typedef enum
+{
+	SIM_OP_POT,
+	SIM_OP_PAD,
+	SIM_OP_RELEASE,
+	SIM_OP_BUTTON,
+	SIM_OP_ACCEL,
+	SIM_OP_DUMP,
+	SIM_OP_ECHO
+} SIM_OP;
+
+typedef struct
+{
+	QWORD time;								// us from the start of the script
+	SIM_OP op;
+	SHORT arg[3];
+	char *text;
+} SIM_STEP;
+
+void Lab1_Main(void);						// main() of main.c, renamed by the Makefile
+
+SIM_COUNTERS simCount;
+
+static SIM_STEP *script;
+static DWORD scriptSteps;
+static QWORD scriptLength;
+static DWORD scriptNext;
+static QWORD scriptStart;
+static DWORD repeats;
+
+static BOOL verbose;
+static BOOL asciiFrames;
+static const char *flashPath;
+
+static QWORD now;
+static QWORD nextTick;
+static QWORD nextAdc;
+static QWORD nextAccel;
+
+static WORD potLevel;
+static WORD padLevel[ADC_TOUCH_CHANNELS];
+static BYTE adcChannel;						// of the conversion in progress
+
+static WORD lastFrame;
+static BOOL inputPending;
+static QWORD inputTime;
+
+static struct
+{
+	DWORD frames;
+	DWORD redraws;
+	SIM_COUNTERS total;
+	DWORD maxOled;
+	DWORD maxOledFrame;
+	QWORD maxCycles;
+	DWORD maxCyclesFrame;
+	DWORD latencies;
+	DWORD unanswered;
+	QWORD latencySum;
+	QWORD latencyMin;
+	QWORD latencyMax;
+	struct timespec wallStart;
+} stats;
+
+
+/*********************************************************************
+* Function:  QWORD Sim_Now(void)
+*
+* Output: virtual time since power-up, us
+*
+********************************************************************/
+QWORD Sim_Now(void)
+{
+	return now;
+}
+
+/*********************************************************************
+* Function:  static void Sim_Fail(const char *what,
+*								  const char *detail, DWORD line)
+*
+* Input: line - script line, 0 if the error is not in the script
+*
+* Overview: reports a script or usage error and stops
+*
+********************************************************************/
+static void Sim_Fail(const char *what, const char *detail, DWORD line)
+{
+	if(line)
+		fprintf(stderr, "lab1sim: line %lu: %s%s\n", (unsigned long)line, what, detail);
+	else
+		fprintf(stderr, "lab1sim: %s%s\n", what, detail);
+	exit(2);
+}
+
+/*********************************************************************
+* Function:  static BYTE Sim_PadIndex(const char *name, DWORD line)
+*
+* Output: A/D channel of the named pad
+*
+********************************************************************/
+static BYTE Sim_PadIndex(const char *name, DWORD line)
+{
+	if(name == NULL)
+		Sim_Fail("pad name missing", "", line);
+	if(!strcmp(name, "right"))
+		return SIM_PAD_RIGHT;
+	if(!strcmp(name, "up"))
+		return SIM_PAD_UP_CH;
+	if(!strcmp(name, "down"))
+		return SIM_PAD_DOWN_CH;
+	if(!strcmp(name, "left"))
+		return SIM_PAD_LEFT;
+	Sim_Fail("unknown pad ", name, line);
+	return 0;
+}
+
+/*********************************************************************
+* Function:  static void Sim_AddStep(QWORD time, SIM_OP op, SHORT a,
+*									 SHORT b, SHORT c, const char *text)
+*
+* Overview: appends one step to the script
+*
+********************************************************************/
+static void Sim_AddStep(QWORD time, SIM_OP op, SHORT a, SHORT b, SHORT c, const char *text)
+{
+	SIM_STEP *step;
+
+	script = realloc(script, (scriptSteps + 1) * sizeof(SIM_STEP));
+	if(script == NULL)
+		Sim_Fail("out of memory", "", 0);
+
+	step = &script[scriptSteps++];
+	step->time = time;
+	step->op = op;
+	step->arg[0] = a;
+	step->arg[1] = b;
+	step->arg[2] = c;
+	step->text = text ? strdup(text) : NULL;
+}
+
+/*********************************************************************
+* Function:  static SHORT Sim_Number(const char *token, DWORD line)
+*
+* Output: the token as a number
+*
+********************************************************************/
+static SHORT Sim_Number(const char *token, DWORD line)
+{
+	char *end;
+	long value;
+
+	if(token == NULL)
+		Sim_Fail("number missing", "", line);
+	value = strtol(token, &end, 0);
+	if(*end || value < -32768 || value > 32767)
+		Sim_Fail("bad number ", token, line);
+	return (SHORT)value;
+}
+
+/*********************************************************************
+* Function:  static void Sim_LoadScript(const char *path)
+*
+* Overview: parses the script into timed steps
+*
+********************************************************************/
+static void Sim_LoadScript(const char *path)
+{
+	FILE *f;
+	char text[256];
+	char *cmd, *rest;
+	QWORD time;
+	DWORD line;
+	BYTE pad, i;
+
+	f = fopen(path, "r");
+	if(f == NULL)
+		Sim_Fail("cannot open ", path, 0);
+
+	time = 0;
+	line = 0;
+	while(fgets(text, sizeof(text), f))
+	{
+		line++;
+		if((rest = strchr(text, '#')) != NULL)
+			*rest = 0;
+		text[strcspn(text, "\r\n")] = 0;
+
+		cmd = strtok(text, " \t");
+		if(cmd == NULL)
+			continue;
+
+		if(!strcmp(cmd, "wait"))
+			time += (QWORD)(WORD)Sim_Number(strtok(NULL, " \t"), line) * 1000;
+		else if(!strcmp(cmd, "pot"))
+			Sim_AddStep(time, SIM_OP_POT, Sim_Number(strtok(NULL, " \t"), line), 0, 0, NULL);
+		else if(!strcmp(cmd, "pad"))
+		{
+			pad = Sim_PadIndex(strtok(NULL, " \t"), line);
+			Sim_AddStep(time, SIM_OP_PAD, pad, Sim_Number(strtok(NULL, " \t"), line), 0, NULL);
+		}
+		else if(!strcmp(cmd, "touch"))
+		{
+			pad = Sim_PadIndex(strtok(NULL, " \t"), line);
+			Sim_AddStep(time, SIM_OP_RELEASE, 0, 0, 0, NULL);
+			if(pad == SIM_PAD_DOWN_CH)
+				Sim_AddStep(time, SIM_OP_PAD, pad, SIM_PAD_DOWN, 0, NULL);
+			else if(pad == SIM_PAD_UP_CH)
+			{
+				Sim_AddStep(time, SIM_OP_PAD, pad, SIM_PAD_UP, 0, NULL);
+				Sim_AddStep(time, SIM_OP_PAD, SIM_PAD_DOWN_CH, SIM_PAD_UP_DOWN, 0, NULL);
+			}
+			else
+				Sim_AddStep(time, SIM_OP_PAD, pad, SIM_PAD_SIDE, 0, NULL);
+		}
+		else if(!strcmp(cmd, "release"))
+			Sim_AddStep(time, SIM_OP_RELEASE, 0, 0, 0, NULL);
+		else if(!strcmp(cmd, "button"))
+			Sim_AddStep(time, SIM_OP_BUTTON, Sim_Number(strtok(NULL, " \t"), line) != 0, 0, 0, NULL);
+		else if(!strcmp(cmd, "click"))
+		{
+			Sim_AddStep(time, SIM_OP_BUTTON, 0, 0, 0, NULL);
+			time += SIM_CLICK_MS * 1000;
+			Sim_AddStep(time, SIM_OP_BUTTON, 1, 0, 0, NULL);
+		}
+		else if(!strcmp(cmd, "accel"))
+		{
+			SHORT x, y;
+
+			x = Sim_Number(strtok(NULL, " \t"), line);
+			y = Sim_Number(strtok(NULL, " \t"), line);
+			Sim_AddStep(time, SIM_OP_ACCEL, x, y, Sim_Number(strtok(NULL, " \t"), line), NULL);
+		}
+		else if(!strcmp(cmd, "shake"))
+		{
+			for(i = 0; i < SIM_SHAKE_SWINGS; i++)
+			{
+				Sim_AddStep(time, SIM_OP_ACCEL, (i & 1) ? -SIM_SHAKE_MG : SIM_SHAKE_MG, 0, 1000, NULL);
+				time += SIM_SHAKE_MS * 1000;
+			}
+			Sim_AddStep(time, SIM_OP_ACCEL, 0, 0, 1000, NULL);
+		}
+		else if(!strcmp(cmd, "dump"))
+			Sim_AddStep(time, SIM_OP_DUMP, 0, 0, 0, strtok(NULL, " \t"));
+		else if(!strcmp(cmd, "echo"))
+		{
+			rest = strtok(NULL, "");
+			Sim_AddStep(time, SIM_OP_ECHO, 0, 0, 0, rest ? rest : "");
+		}
+		else
+			Sim_Fail("unknown command ", cmd, line);
+	}
+	fclose(f);
+
+	scriptLength = time;
+}
+
+/*********************************************************************
+* Function:  static void Sim_Input(void)
+*
+* Overview: marks an input change for the latency measurement
+*
+********************************************************************/
+static void Sim_Input(void)
+{
+	if(!inputPending)
+		inputTime = now;
+	inputPending = TRUE;
+}
+
+/*********************************************************************
+* Function:  static void Sim_RunStep(const SIM_STEP *step)
+*
+* Overview: applies one script step
+*
+********************************************************************/
+static void Sim_RunStep(const SIM_STEP *step)
+{
+	BYTE i;
+
+	switch(step->op)
+	{
+		case SIM_OP_POT:
+			potLevel = step->arg[0] & 0x3FF;
+			Sim_Input();
+			break;
+
+		case SIM_OP_PAD:
+			padLevel[step->arg[0]] = step->arg[1] & 0x3FF;
+			Sim_Input();
+			break;
+
+		case SIM_OP_RELEASE:
+			for(i = 0; i < ADC_TOUCH_CHANNELS; i++)
+				padLevel[i] = SIM_PAD_IDLE;
+			Sim_Input();
+			break;
+
+		case SIM_OP_BUTTON:
+			PORTBbits.RB0 = step->arg[0];
+			Sim_Input();
+			break;
+
+		case SIM_OP_ACCEL:
+			Sim_AccelSet(step->arg[0], step->arg[1], step->arg[2]);
+			Sim_Input();
+			break;
+
+		case SIM_OP_DUMP:
+			if(step->text == NULL)
+			{
+				printf("t=%.3f ms frame %lu\n", now / 1000.0, (unsigned long)stats.frames);
+				Sim_OledAscii(stdout);
+			}
+			else if(!Sim_OledPbm(step->text))
+				Sim_Fail("cannot write ", step->text, 0);
+			break;
+
+		case SIM_OP_ECHO:
+			printf("%s\n", step->text);
+			break;
+	}
+}
+
+/*********************************************************************
+* Function:  static void Sim_Report(void)
+*
+* Overview: prints the summary of the run
+*
+********************************************************************/
+static void Sim_Report(void)
+{
+	struct timespec wallEnd;
+	double wall;
+
+	clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+	wall = (wallEnd.tv_sec - stats.wallStart.tv_sec) + (wallEnd.tv_nsec - stats.wallStart.tv_nsec) / 1e9;
+	if(stats.frames == 0)
+		stats.frames = 1;
+
+	printf("\n");
+	printf("virtual time     %.3f s\n", now / 1e6);
+	printf("frames           %lu, %lu redrawn, %u overruns\n", (unsigned long)stats.frames,
+		(unsigned long)stats.redraws, Sched_FrameOverruns());
+	printf("oled bytes       %lu, %.1f per frame, max %lu (frame %lu)\n",
+		(unsigned long)stats.total.oledBytes, (double)stats.total.oledBytes / stats.frames,
+		(unsigned long)stats.maxOled, (unsigned long)stats.maxOledFrame);
+	printf("spi bytes        %lu, %.1f per frame\n",
+		(unsigned long)stats.total.spiBytes, (double)stats.total.spiBytes / stats.frames);
+	printf("interrupts       %lu\n", (unsigned long)stats.total.interrupts);
+	printf("flash writes     %lu\n", (unsigned long)stats.total.flashOps);
+	printf("cycles (est.)    %.0f per frame, max %llu = %.1f%% of a frame (frame %lu)\n",
+		(double)stats.total.cycles / stats.frames, (unsigned long long)stats.maxCycles,
+		100.0 * stats.maxCycles / SIM_FRAME_CYCLES, (unsigned long)stats.maxCyclesFrame);
+	if(stats.latencies)
+		printf("latency          %lu inputs, min %.1f avg %.1f max %.1f ms, %lu without redraw\n",
+			(unsigned long)stats.latencies, stats.latencyMin / 1000.0,
+			stats.latencySum / 1000.0 / stats.latencies, stats.latencyMax / 1000.0,
+			(unsigned long)stats.unanswered);
+	else
+		printf("latency          no redraw after an input, %lu without\n", (unsigned long)stats.unanswered);
+	printf("host             %.3f s, %.0f frames/s, %.0fx real time\n",
+		wall, stats.frames / wall, wall > 0 ? now / 1e6 / wall : 0);
+}
+
+/*********************************************************************
+* Function:  static void Sim_Finish(void)
+*
+* Overview: ends the run after the last script step
+*
+********************************************************************/
+static void Sim_Finish(void)
+{
+	Sim_UartFlush();
+	Sim_Report();
+
+	if(flashPath && !Sim_FlashSave(flashPath))
+		Sim_Fail("cannot write ", flashPath, 0);
+	exit(0);
+}
+
+/*********************************************************************
+* Function:  static void Sim_RunScript(void)
+*
+* Overview: applies the steps that are due, and ends the run or
+*			starts the next repeat after the last one
+*
+********************************************************************/
+static void Sim_RunScript(void)
+{
+	while(scriptNext < scriptSteps && scriptStart + script[scriptNext].time <= now)
+		Sim_RunStep(&script[scriptNext++]);
+
+	if(scriptNext < scriptSteps || now < scriptStart + scriptLength)
+		return;
+
+	if(--repeats == 0)
+		Sim_Finish();
+
+	scriptStart = now;
+	scriptNext = 0;
+	while(scriptNext < scriptSteps && script[scriptNext].time == 0)
+		Sim_RunStep(&script[scriptNext++]);
+}
+
+/*********************************************************************
+* Function:  static QWORD Sim_ScriptDue(void)
+*
+* Output: time of the next script step, or of the end of the script
+*
+********************************************************************/
+static QWORD Sim_ScriptDue(void)
+{
+	if(scriptNext < scriptSteps)
+		return scriptStart + script[scriptNext].time;
+	return scriptStart + scriptLength;
+}
+
+/*********************************************************************
+* Function:  static void Sim_FrameEnd(void)
+*
+* Overview: books the counters since the last frame to the frame
+*			the firmware just finished
+*
+********************************************************************/
+static void Sim_FrameEnd(void)
+{
+	QWORD latency;
+
+	stats.frames++;
+	stats.total.oledBytes += simCount.oledBytes;
+	stats.total.spiBytes += simCount.spiBytes;
+	stats.total.interrupts += simCount.interrupts;
+	stats.total.flashOps += simCount.flashOps;
+	stats.total.cycles += simCount.cycles;
+
+	if(simCount.oledBytes > stats.maxOled)
+	{
+		stats.maxOled = simCount.oledBytes;
+		stats.maxOledFrame = stats.frames;
+	}
+	if(simCount.cycles > stats.maxCycles)
+	{
+		stats.maxCycles = simCount.cycles;
+		stats.maxCyclesFrame = stats.frames;
+	}
+
+	latency = 0;
+	if(inputPending && now - inputTime > SIM_LATENCY_TIMEOUT_US)
+	{
+		stats.unanswered++;
+		inputPending = FALSE;
+	}
+	if(simCount.oledBytes)
+	{
+		stats.redraws++;
+		if(inputPending)
+		{
+			latency = now + simCount.cycles / SIM_CYCLES_PER_US - inputTime;
+			if(stats.latencies == 0 || latency < stats.latencyMin)
+				stats.latencyMin = latency;
+			if(latency > stats.latencyMax)
+				stats.latencyMax = latency;
+			stats.latencySum += latency;
+			stats.latencies++;
+			inputPending = FALSE;
+		}
+	}
+
+	if(verbose)
+	{
+		printf("frame %6lu t=%10.3f ms oled=%5lu spi=%4lu irq=%4lu cycles=%7llu (%5.1f%%)",
+			(unsigned long)stats.frames, now / 1000.0, (unsigned long)simCount.oledBytes,
+			(unsigned long)simCount.spiBytes, (unsigned long)simCount.interrupts,
+			(unsigned long long)simCount.cycles, 100.0 * simCount.cycles / SIM_FRAME_CYCLES);
+		if(latency)
+			printf(" latency=%.1f ms", latency / 1000.0);
+		printf("\n");
+	}
+	if(asciiFrames && simCount.oledBytes)
+		Sim_OledAscii(stdout);
+
+	memset(&simCount, 0, sizeof(simCount));
+}
+
+/*********************************************************************
+* Function:  static void Sim_Convert(void)
+*
+* Overview: completes an A/D conversion on the selected channel
+*
+********************************************************************/
+static void Sim_Convert(void)
+{
+	adcChannel = ADCON0bits.CHS;
+	if(adcChannel == ADC_POT_CHANNEL)
+		ADRES = potLevel;
+	else if(adcChannel < ADC_TOUCH_CHANNELS)
+		ADRES = padLevel[adcChannel];
+	else
+		ADRES = 0;
+
+	ADCON0bits.GO = 0;
+	PIR1bits.ADIF = 1;
+}
+
+/*********************************************************************
+* Function:  static BOOL Sim_Interrupt(void)
+*
+* Output: TRUE if an enabled interrupt is pending, which ends Sleep()
+*
+* Overview: runs the interrupt service routine while GIE is set and
+*			an enabled flag is pending. Touch conversions started by
+*			the A/D interrupt complete right away.
+*
+********************************************************************/
+static BOOL Sim_Interrupt(void)
+{
+	BOOL pending;
+
+	pending = FALSE;
+	for(;;)
+	{
+		if(!(PIE1bits.ADIE && PIR1bits.ADIF) && !(INTCON3bits.INT1IE && INTCON3bits.INT1IF)
+			&& !(PIE1bits.TMR2IE && PIR1bits.TMR2IF))
+			return pending;
+
+		pending = TRUE;
+		if(!INTCONbits.GIE)
+			return pending;
+
+		INTCONbits.GIE = 0;
+		simCount.interrupts++;
+		simCount.cycles += SIM_CYCLES_ISR;
+
+		if(PIE1bits.ADIE && PIR1bits.ADIF)
+		{
+			simCount.cycles += adcChannel == ADC_POT_CHANNEL ? SIM_CYCLES_ISR_POT : SIM_CYCLES_ISR_TOUCH;
+			AdcSched_ISR();
+		}
+		if(INTCON3bits.INT1IE && INTCON3bits.INT1IF)
+		{
+			simCount.cycles += SIM_CYCLES_ISR_ACCEL;
+			Accel_ISR();
+		}
+		if(PIE1bits.TMR2IE && PIR1bits.TMR2IF)
+		{
+			simCount.cycles += SIM_CYCLES_ISR_TICK;
+			Sched_ISR();
+		}
+		INTCONbits.GIE = 1;
+
+		if(ADCON0bits.GO)
+			Sim_Convert();
+	}
+}
+
+/*********************************************************************
+* Function:  static void Sim_Advance(QWORD until, BOOL clocked)
+*
+* Input: clocked - FALSE in Sleep mode, where Timer1, Timer2 and the
+*				   A/D trigger stop
+*
+* Overview: moves virtual time to the next event due by the given
+*			time and runs it
+*
+********************************************************************/
+static void Sim_Advance(QWORD until, BOOL clocked)
+{
+	QWORD next;
+
+	next = until;
+	if(clocked && nextTick < next)
+		next = nextTick;
+	if(clocked && nextAdc < next)
+		next = nextAdc;
+	if(nextAccel < next)
+		next = nextAccel;
+	now = next;
+
+	if(clocked && now >= nextTick)
+	{
+		if(T2CONbits.TMR2ON)
+			PIR1bits.TMR2IF = 1;
+		nextTick += SIM_TICK_US;
+	}
+	if(clocked && now >= nextAdc)
+	{
+		if(T1CONbits.TMR1ON && CCP2CON == 0x0B && !ADCON0bits.GO)
+			Sim_Convert();						// ECCP2 special event trigger
+		nextAdc += SIM_ADC_TRIGGER_US;
+	}
+	if(now >= nextAccel)
+	{
+		if(Sim_AccelSample())
+			INTCON3bits.INT1IF = 1;
+		nextAccel += SIM_ACCEL_SAMPLE_US;
+	}
+
+	Sim_RunScript();
+}
+
+/*********************************************************************
+* Function:  void Sim_Sleep(void)
+*
+* Overview: the SLEEP instruction. With IDLEN set the peripherals run
+*			and any enabled interrupt wakes the CPU; without it only
+*			the BMA150 INT line or, with SWDTEN set, the watchdog can.
+*			A watchdog wake clears RCON TO.
+*
+********************************************************************/
+void Sim_Sleep(void)
+{
+	QWORD wdt;
+
+	if(Sched_FrameCount() != lastFrame)
+	{
+		lastFrame = Sched_FrameCount();
+		Sim_FrameEnd();
+	}
+
+	if(OSCCONbits.IDLEN)
+	{
+		while(!Sim_Interrupt())
+			Sim_Advance(Sim_ScriptDue(), TRUE);
+		return;
+	}
+
+	RCONbits.TO = 1;
+	RCONbits.PD = 0;
+	wdt = now + SIM_WDT_US;
+	while(!Sim_Interrupt())
+	{
+		if(WDTCONbits.SWDTEN && now >= wdt)
+		{
+			RCONbits.TO = 0;
+			break;
+		}
+		Sim_Advance(WDTCONbits.SWDTEN && wdt < Sim_ScriptDue() ? wdt : Sim_ScriptDue(), FALSE);
+	}
+	nextTick = now + SIM_TICK_US;
+	nextAdc = now + SIM_ADC_TRIGGER_US;
+}
+
+/*********************************************************************
+* Function:  static void Sim_Usage(void)
+*
+********************************************************************/
+static void Sim_Usage(void)
+{
+	fprintf(stderr, "usage: lab1sim [-v] [-a] [-r count] [-f flash.bin] script\n");
+	exit(2);
+}
+
+int main(int argc, char **argv)
+{
+	int i;
+	BYTE pad;
+
+	repeats = 1;
+	for(i = 1; i < argc && argv[i][0] == '-'; i++)
+	{
+		if(!strcmp(argv[i], "-v"))
+			verbose = TRUE;
+		else if(!strcmp(argv[i], "-a"))
+			asciiFrames = TRUE;
+		else if(!strcmp(argv[i], "-r") && i + 1 < argc)
+			repeats = strtoul(argv[++i], NULL, 0);
+		else if(!strcmp(argv[i], "-f") && i + 1 < argc)
+			flashPath = argv[++i];
+		else
+			Sim_Usage();
+	}
+	if(i != argc - 1 || repeats == 0)
+		Sim_Usage();
+	Sim_LoadScript(argv[i]);
+
+	Sim_HwReset();
+	Sim_OledReset();
+	Sim_AccelReset();
+	if(flashPath)
+		Sim_FlashLoad(flashPath);
+
+	potLevel = 512;
+	for(pad = 0; pad < ADC_TOUCH_CHANNELS; pad++)
+		padLevel[pad] = SIM_PAD_IDLE;
+	nextTick = SIM_TICK_US;
+	nextAdc = SIM_ADC_TRIGGER_US;
+	nextAccel = SIM_ACCEL_SAMPLE_US;
+
+	// the power-up state, applied before the firmware starts
+	while(scriptNext < scriptSteps && script[scriptNext].time == 0)
+		Sim_RunStep(&script[scriptNext++]);
+	inputPending = FALSE;
+
+	clock_gettime(CLOCK_MONOTONIC, &stats.wallStart);
+	Lab1_Main();
+	return 0;
+}
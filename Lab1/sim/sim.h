@@ -0,0 +1,96 @@
+/********************************************************************
+  File Information:
+    FileName:     	sim.h
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    Interfaces between the parts of the Lab1 host simulator:
+
+      sim.c         virtual time, interrupts, input script, report
+      sim_hw.c      register storage and access hooks, flash, the
+                    mTouch / BMA150 driver entry points
+      sim_oled.c    SSD1303 controller on the OLED bus
+      sim_bma150.c  BMA150 on MSSP2 and its INT line
+
+    Time only moves while the firmware sleeps (Sleep() in
+    Sched_WaitFrame() and SleepUntilMotion()); code between two
+    sleeps takes no virtual time. Its CPU cost is estimated from the
+    bus traffic and interrupts it causes, with the SIM_CYCLES_xxx
+    costs below (instruction cycles at Fosc/4 = 12 MHz).
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+#ifndef SIM_H
+#define SIM_H
+
+/******** Include files **********************/
+#include <stdio.h>
+#include "GenericTypeDefs.h"
+/*********************************************/
+
+#define SIM_CYCLES_PER_US		12
+
+// Estimated cost of the work the models can see, in instruction cycles
+#define SIM_CYCLES_OLED_BYTE	24			// WriteCommand()/WriteData(): call, 10 port writes
+#define SIM_CYCLES_SPI_BYTE		48			// Accel_Transfer(): load, 8 SCK at Fosc/16, poll
+#define SIM_CYCLES_ISR			30			// vector, context save/restore, dispatch
+#define SIM_CYCLES_ISR_TICK		10			// Sched_ISR()
+#define SIM_CYCLES_ISR_POT		25			// AdcSched_ISR(), pot slot
+#define SIM_CYCLES_ISR_TOUCH	60			// AdcSched_ISR(), touch slot with the CTMU charge
+#define SIM_CYCLES_ISR_ACCEL	8			// Accel_ISR()
+#define SIM_CYCLES_FLASH		(2800 * SIM_CYCLES_PER_US)	// TIW, word write or block erase
+
+// Peripheral rates
+#define SIM_TICK_US				1000		// Timer2 period, see sched.c
+#define SIM_ADC_TRIGGER_US		250			// ECCP2 special event, see adc_sched.c
+#define SIM_ACCEL_SAMPLE_US		20000		// BMA150 new data, 50 Hz
+#define SIM_WDT_US				(4000ULL * 32768)	// 4 ms x WDTPS 1:32768
+
+#define SIM_FLASH_SIZE			0x10000
+
+// Bus activity and estimated cost, accumulated until read
+typedef struct
+{
+	DWORD oledBytes;
+	DWORD spiBytes;
+	DWORD interrupts;
+	DWORD flashOps;
+	QWORD cycles;
+} SIM_COUNTERS;
+
+extern SIM_COUNTERS simCount;
+
+// sim.c
+QWORD Sim_Now(void);
+void Sim_Sleep(void);
+
+// sim_hw.c
+void Sim_HwReset(void);
+BYTE Sim_FlashRead(WORD address);
+void Sim_FlashErase(WORD address);
+void Sim_FlashWrite(WORD address, WORD data);
+BOOL Sim_FlashLoad(const char *path);
+BOOL Sim_FlashSave(const char *path);
+void Sim_UartFlush(void);
+
+// sim_oled.c
+void Sim_OledReset(void);
+void Sim_OledWrite(BOOL data, BYTE value);
+BOOL Sim_OledPixel(BYTE x, BYTE y);
+void Sim_OledAscii(FILE *out);
+BOOL Sim_OledPbm(const char *path);
+
+// sim_bma150.c
+void Sim_AccelReset(void);
+void Sim_AccelSet(SHORT xMg, SHORT yMg, SHORT zMg);
+void Sim_AccelSelect(void);
+BYTE Sim_AccelTransfer(BYTE data);
+BOOL Sim_AccelSample(void);
+
+#endif
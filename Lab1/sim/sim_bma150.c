@@ -0,0 +1,201 @@
+/********************************************************************
+  File Information:
+    FileName:     	sim_bma150.c
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    BMA150 model on MSSP2 (4 wire SPI, chip select on RC7) with its
+    INT output on RB1 / INT1.
+
+    The script sets the acceleration in milli-g; the part samples it
+    every SIM_ACCEL_SAMPLE_US into the 10 bit data registers at the
+    +/-2 g range, through its 25 Hz bandwidth filter (first order,
+    half way to the input per sample), so a step in the script
+    settles over a few samples like a real movement does. INT follows the interrupt set up in registers 0x0B
+    and 0x15: a pulse per sample for new_data_int, or high while the
+    change between samples exceeds the any_motion threshold for the
+    programmed number of samples.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "accel.h"
+#include "sim.h"
+/*********************************************/
+
+#define BMA150_REGISTERS		0x80
+#define BMA150_SPI_READ			0x80
+#define BMA150_RAW_MAX			511
+
+#define BMA150_MOTION_LSB		4			// threshold LSB (15.6 mg) in data LSBs
+
+static BYTE reg[BMA150_REGISTERS];
+static SHORT input[3];						// raw counts the next sample takes
+static SHORT sample[3];					// filtered, in the data registers
+static BYTE motionCount;
+
+static BOOL frameStart;
+static BYTE address;
+static BOOL reading;
+
+
+/*********************************************************************
+* Function:  static SHORT Sim_AccelRaw(SHORT mg)
+*
+* Output: data register counts at the +/-2 g range, saturated
+*
+********************************************************************/
+static SHORT Sim_AccelRaw(SHORT mg)
+{
+	LONG raw;
+
+	raw = (LONG)mg * ACCEL_LSB_PER_G / 1000;
+	if(raw > BMA150_RAW_MAX)
+		raw = BMA150_RAW_MAX;
+	if(raw < -BMA150_RAW_MAX - 1)
+		raw = -BMA150_RAW_MAX - 1;
+	return (SHORT)raw;
+}
+
+/*********************************************************************
+* Function:  void Sim_AccelReset(void)
+*
+* Overview: power-on register values, lying flat at rest
+*
+********************************************************************/
+void Sim_AccelReset(void)
+{
+	BYTE i;
+
+	memset(reg, 0, sizeof(reg));
+	reg[BMA150_CHIP_ID] = 0x02;
+	reg[0x01] = 0x12;							// ml/al version
+	reg[BMA150_TEMP] = 108;						// 24 C
+	reg[BMA150_REG_INT_EN] = 0x03;				// low_g, high_g
+	reg[BMA150_REG_MOTION_THRES] = 0x14;
+	reg[BMA150_REG_RANGE_BW] = 0x00;							// +/-2 g, 25 Hz bandwidth
+	reg[BMA150_REG_INT_CTRL] = 0x80;			// 4 wire SPI
+
+	Sim_AccelSet(0, 0, 1000);
+	for(i = 0; i < 3; i++)
+		sample[i] = input[i];
+	motionCount = 0;
+	frameStart = TRUE;
+
+	PORTBbits.RB1 = 0;
+}
+
+/*********************************************************************
+* Function:  void Sim_AccelSet(SHORT xMg, SHORT yMg, SHORT zMg)
+*
+* Overview: acceleration seen from the next sample on
+*
+********************************************************************/
+void Sim_AccelSet(SHORT xMg, SHORT yMg, SHORT zMg)
+{
+	input[0] = Sim_AccelRaw(xMg);
+	input[1] = Sim_AccelRaw(yMg);
+	input[2] = Sim_AccelRaw(zMg);
+}
+
+/*********************************************************************
+* Function:  BOOL Sim_AccelSample(void)
+*
+* Output: TRUE on a rising edge of INT
+*
+* Overview: takes one sample and updates INT (RB1)
+*
+********************************************************************/
+BOOL Sim_AccelSample(void)
+{
+	BYTE i, threshold;
+	SHORT step;
+	BOOL moved, pulse, motion, rising;
+
+	threshold = reg[BMA150_REG_MOTION_THRES];
+	moved = FALSE;
+	for(i = 0; i < 3; i++)
+	{
+		step = (input[i] - sample[i]) / 2;
+		if(step == 0)
+			step = input[i] - sample[i];
+		if(abs(step) > threshold * BMA150_MOTION_LSB)
+			moved = TRUE;
+		sample[i] += step;
+
+		reg[BMA150_ACC_X_LSB + 2 * i] = (BYTE)((sample[i] & 0x03) << 6) | BMA150_NEW_DATA_X;
+		reg[BMA150_ACC_X_MSB + 2 * i] = (BYTE)(sample[i] >> 2);
+	}
+
+	if(moved)
+	{
+		if(motionCount < 0xFF)
+			motionCount++;
+	}
+	else
+		motionCount = 0;
+
+	pulse = (reg[BMA150_REG_INT_CTRL] & BMA150_NEW_DATA_INT) != 0;
+	motion = (reg[BMA150_REG_INT_CTRL] & BMA150_ADV_INT) && (reg[BMA150_REG_INT_EN] & BMA150_ANY_MOTION)
+		&& motionCount > (reg[BMA150_REG_MOTION_DUR] >> 6) * 2;
+
+	rising = (pulse || motion) && !PORTBbits.RB1;
+	PORTBbits.RB1 = motion;						// the new data pulse is over before the next sample
+	return rising;
+}
+
+/*********************************************************************
+* Function:  void Sim_AccelSelect(void)
+*
+* Overview: chip select edge; the next byte is an address
+*
+********************************************************************/
+void Sim_AccelSelect(void)
+{
+	frameStart = TRUE;
+}
+
+/*********************************************************************
+* Function:  BYTE Sim_AccelTransfer(BYTE data)
+*
+* Input: data - byte clocked in on SDI
+*
+* Output: byte clocked out on SDO
+*
+* Overview: the first byte of a frame is the address with the read
+*			flag; the address increments over the following bytes
+*
+********************************************************************/
+BYTE Sim_AccelTransfer(BYTE data)
+{
+	BYTE out;
+
+	if(frameStart)
+	{
+		frameStart = FALSE;
+		address = data & ~BMA150_SPI_READ;
+		reading = (data & BMA150_SPI_READ) != 0;
+		return 0xFF;
+	}
+
+	out = 0xFF;
+	if(reading)
+	{
+		out = reg[address];
+		if(address >= BMA150_ACC_X_MSB && address <= BMA150_ACC_Z_MSB && (address & 1))
+			reg[address - 1] &= ~BMA150_NEW_DATA_X;	// new_data clears when the MSB is read
+	}
+	else if(address >= BMA150_REG_INT_EN)		// below are read only
+		reg[address] = data;
+	address = (address + 1) & (BMA150_REGISTERS - 1);
+	return out;
+}
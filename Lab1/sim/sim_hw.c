@@ -0,0 +1,306 @@
+/********************************************************************
+  File Information:
+    FileName:     	sim_hw.c
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    Register storage for include/p18cxxx.h, the access hooks that
+    connect the OLED bus, MSSP2 and UART2 to the models, program
+    flash for nvstore.c, and the library calls Lab1 links against
+    (mTouch, BMA150 driver, itoa).
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "mtouch.h"
+#include "BMA150.h"
+#include "sim.h"
+/*********************************************/
+
+volatile BYTE ADCON1, ANCON0, ANCON1, CCP2CON, CCPR2H, CCPR2L, EECON2, PR2,
+			  RPINR1, RPOR11, SPBRG2, SPBRGH2, SSP2BUF, TMR1H, TMR1L, TMR2,
+			  TXSTA2, TABLAT, TBLPTRU, TBLPTRH, TBLPTRL, PORTD;
+volatile WORD ADRES;
+
+ADCON0_SFR simADCON0;
+BAUDCON2_SFR simBAUDCON2;
+CTMUCONH_SFR simCTMUCONH;
+CTMUCONL_SFR simCTMUCONL;
+EECON1_SFR simEECON1;
+INTCON_SFR simINTCON;
+INTCON2_SFR simINTCON2;
+INTCON3_SFR simINTCON3;
+OSCCON_SFR simOSCCON;
+PIE1_SFR simPIE1;
+PIR1_SFR simPIR1;
+PIR3_SFR simPIR3;
+PPSCON_SFR simPPSCON;
+RCON_SFR simRCON;
+WDTCON_SFR simWDTCON;
+RCSTA2_SFR simRCSTA2;
+SSP2STAT_SFR simSSP2STAT;
+T1CON_SFR simT1CON;
+T2CON_SFR simT2CON;
+TXREG2_SFR simTXREG2;
+PORTB_SFR simPORTB;
+LATB_SFR simLATB;
+TRISB_SFR simTRISB;
+PORTC_SFR simPORTC;
+LATC_SFR simLATC;
+TRISC_SFR simTRISC;
+LATD_SFR simLATD;
+TRISD_SFR simTRISD;
+LATE_SFR simLATE;
+TRISE_SFR simTRISE;
+
+static BYTE flash[SIM_FLASH_SIZE];
+static BOOL oledStrobed;
+static BOOL uartPending;
+
+
+/*********************************************************************
+* Function:  void Sim_HwReset(void)
+*
+* Overview: power-on state of the registers. Program flash is kept,
+*			like on the part.
+*
+********************************************************************/
+void Sim_HwReset(void)
+{
+	static BOOL flashInit;
+
+	if(!flashInit)
+	{
+		memset(flash, 0xFF, sizeof(flash));
+		flashInit = TRUE;
+	}
+
+	simINTCON.byte = 0;
+	simINTCON3.byte = 0;
+	simPIE1.byte = 0;
+	simPIR1.byte = 0;
+	simPIR3.byte = 0;
+	simPIR3.bits.TX2IF = 1;						// transmit buffer empty
+	simADCON0.byte = 0;
+	simT1CON.byte = 0;
+	simT2CON.byte = 0;
+	simOSCCON.byte = 0;
+	simWDTCON.byte = 0;
+	simRCON.byte = 0x1C;						// TO, PD and RI set
+	CCP2CON = 0;
+
+	simPORTB.byte = 0xFF;						// RB0 pulled up, button released
+	simPORTC.byte = 0;
+	simLATC.byte = 0xFF;
+	simLATE.byte = 0x04;						// OLED CS# high, the bus starts idle
+	oledStrobed = FALSE;
+	uartPending = FALSE;
+}
+
+/*********************************************************************
+* Function:  LATE_SFR *Sim_LATE(void)
+*
+* Overview: OLED bus. The SSD1303 takes D7:D0 and D/C# on a write
+*			strobe (CS# and WR# low); the strobe is seen on the next
+*			access to the port, which WriteCommand()/WriteData()
+*			always make to raise WR#.
+*
+********************************************************************/
+LATE_SFR *Sim_LATE(void)
+{
+	if(!simLATE.bits.LATE2 && !simLATE.bits.LATE1)
+	{
+		if(!oledStrobed)
+			Sim_OledWrite(simLATB.bits.LATB5, simLATD.byte);
+		oledStrobed = TRUE;
+	}
+	else
+		oledStrobed = FALSE;
+
+	return &simLATE;
+}
+
+/*********************************************************************
+* Function:  LATC_SFR *Sim_LATC(void)
+*
+* Overview: BMA150 chip select; either edge ends an SPI frame
+*
+********************************************************************/
+LATC_SFR *Sim_LATC(void)
+{
+	Sim_AccelSelect();
+	return &simLATC;
+}
+
+/*********************************************************************
+* Function:  SSP2STAT_SFR *Sim_SSP2STAT(void)
+*
+* Overview: MSSP2. Polling BF completes the transfer of the byte
+*			last loaded into SSP2BUF.
+*
+********************************************************************/
+SSP2STAT_SFR *Sim_SSP2STAT(void)
+{
+	SSP2BUF = Sim_AccelTransfer(SSP2BUF);
+	simSSP2STAT.bits.BF = 1;
+
+	simCount.spiBytes++;
+	simCount.cycles += SIM_CYCLES_SPI_BYTE;
+	return &simSSP2STAT;
+}
+
+/*********************************************************************
+* Function:  PIR3_SFR *Sim_PIR3(void), TXREG2_SFR *Sim_TXREG2(void)
+*
+* Overview: UART2. A byte loaded into TXREG2 is sent to stdout when
+*			TX2IF is next polled, or at the end of the run.
+*
+********************************************************************/
+PIR3_SFR *Sim_PIR3(void)
+{
+	Sim_UartFlush();
+	simPIR3.bits.TX2IF = 1;
+	return &simPIR3;
+}
+
+TXREG2_SFR *Sim_TXREG2(void)
+{
+	Sim_UartFlush();
+	uartPending = TRUE;
+	return &simTXREG2;
+}
+
+void Sim_UartFlush(void)
+{
+	if(uartPending)
+		putchar(simTXREG2.byte);
+	uartPending = FALSE;
+}
+
+/*********************************************************************
+* Function:  BYTE Sim_FlashRead(WORD address)
+*
+* Output: program memory byte, as a TBLRD would return it
+*
+********************************************************************/
+BYTE Sim_FlashRead(WORD address)
+{
+	return flash[address];
+}
+
+/*********************************************************************
+* Function:  void Sim_FlashErase(WORD address)
+*
+* Overview: erases the 1 KB block holding the address
+*
+********************************************************************/
+void Sim_FlashErase(WORD address)
+{
+	memset(&flash[address & ~0x3FF], 0xFF, 1024);
+
+	simCount.flashOps++;
+	simCount.cycles += SIM_CYCLES_FLASH;
+}
+
+/*********************************************************************
+* Function:  void Sim_FlashWrite(WORD address, WORD data)
+*
+* Overview: programs one word. Like the part, programming can only
+*			clear bits.
+*
+********************************************************************/
+void Sim_FlashWrite(WORD address, WORD data)
+{
+	address &= ~1;
+	flash[address] &= (BYTE)data;
+	flash[address + 1] &= (BYTE)(data >> 8);
+
+	simCount.flashOps++;
+	simCount.cycles += SIM_CYCLES_FLASH;
+}
+
+/*********************************************************************
+* Function:  BOOL Sim_FlashLoad(const char *path),
+*			 BOOL Sim_FlashSave(const char *path)
+*
+* Output: FALSE if the image could not be read or written. A missing
+*		  image leaves the flash erased.
+*
+* Overview: keeps the flash (and so the nvstore pages) in a file
+*			between runs, for warm start scenarios
+*
+********************************************************************/
+BOOL Sim_FlashLoad(const char *path)
+{
+	FILE *f;
+	size_t read;
+
+	memset(flash, 0xFF, sizeof(flash));
+	f = fopen(path, "rb");
+	if(f == NULL)
+		return FALSE;
+
+	read = fread(flash, 1, sizeof(flash), f);
+	fclose(f);
+	return read == sizeof(flash);
+}
+
+BOOL Sim_FlashSave(const char *path)
+{
+	FILE *f;
+	size_t written;
+
+	f = fopen(path, "wb");
+	if(f == NULL)
+		return FALSE;
+
+	written = fwrite(flash, 1, sizeof(flash), f);
+	return fclose(f) == 0 && written == sizeof(flash);
+}
+
+/*********************************************************************
+* Function:  void mTouchInit(void), void mTouchCalibrate(void)
+*
+* Overview: the pads are read through the A/D scheduler; the modelled
+*			channels need no set up or calibration
+*
+********************************************************************/
+void mTouchInit(void)
+{
+}
+
+void mTouchCalibrate(void)
+{
+}
+
+/*********************************************************************
+* Function:  void InitBma150(void)
+*
+* Overview: the modelled BMA150 powers up in the range and bandwidth
+*			InitBma150() selects, and MSSP2 needs no set up
+*
+********************************************************************/
+void InitBma150(void)
+{
+}
+
+/*********************************************************************
+* Function:  char *itoa(int value, char *string)
+*
+* Output: string, holding value in decimal (C18 library semantics)
+*
+********************************************************************/
+char *itoa(int value, char *string)
+{
+	sprintf(string, "%d", (SHORT)value);
+	return string;
+}
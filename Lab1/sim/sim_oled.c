@@ -0,0 +1,222 @@
+/********************************************************************
+  File Information:
+    FileName:     	sim_oled.c
+    Dependencies:   See INCLUDES section
+    Processor:      Host (Linux, gcc)
+    Hardware:       Lab1 simulator
+    Complier:  	    gcc
+
+  File Description:
+    SSD1303 model behind the 8080 bus of oled.c: 132 x 64 display
+    RAM in 8 pages, page addressing, display start line, normal /
+    inverse and on / off. The panel shows columns OFFSET..OFFSET+127.
+    Segment and COM remap (A1, C8) only undo the panel mounting and
+    are not modelled: the picture is kept as the firmware draws it.
+
+    Change History:
+     Rev   Date         Description
+     1.0                Initial release
+
+********************************************************************/
+
+/******** Include files **********************/
+#include "GenericTypeDefs.h"
+#include "Compiler.h"
+#include "oled.h"
+#include "sim.h"
+/*********************************************/
+
+#define OLED_PAGES				8
+#define OLED_COLUMNS			132
+#define OLED_LINES				64
+
+static BYTE ram[OLED_PAGES][OLED_COLUMNS];
+static BYTE page;
+static BYTE column;
+static BYTE startLine;
+static BOOL inverse;
+static BOOL displayOn;
+
+static BYTE arguments;						// still to come for the last command
+
+
+/*********************************************************************
+* Function:  void Sim_OledReset(void)
+*
+* Overview: controller state after RES#; RAM content is undefined on
+*			the part and starts dark here
+*
+********************************************************************/
+void Sim_OledReset(void)
+{
+	memset(ram, 0, sizeof(ram));
+	page = 0;
+	column = 0;
+	startLine = 0;
+	inverse = FALSE;
+	displayOn = FALSE;
+	arguments = 0;
+}
+
+/*********************************************************************
+* Function:  static BYTE Sim_OledArguments(BYTE cmd)
+*
+* Output: number of argument bytes that follow the command
+*
+********************************************************************/
+static BYTE Sim_OledArguments(BYTE cmd)
+{
+	switch(cmd)
+	{
+		case 0x81:								// contrast
+		case 0x82:								// brightness
+		case 0xA8:								// multiplex ratio
+		case 0xAD:								// DC-DC
+		case 0xD3:								// display offset
+		case 0xD5:								// clock divide
+		case 0xD8:								// area colour / low power
+		case 0xD9:								// pre-charge period
+		case 0xDA:								// COM pins
+		case 0xDB:								// VCOMH
+			return 1;
+		case 0x91:								// look up table
+			return 4;
+	}
+	return 0;
+}
+
+/*********************************************************************
+* Function:  static void Sim_OledCommand(BYTE cmd)
+*
+* Overview: decodes a single byte command
+*
+********************************************************************/
+static void Sim_OledCommand(BYTE cmd)
+{
+	if(cmd <= 0x0F)
+		column = (column & 0xF0) | cmd;
+	else if(cmd <= 0x1F)
+		column = (column & 0x0F) | ((cmd & 0x0F) << 4);
+	else if(cmd >= 0x40 && cmd <= 0x7F)
+		startLine = cmd & 0x3F;
+	else if(cmd >= 0xB0 && cmd <= 0xB7)
+		page = cmd & 0x07;
+	else if(cmd == 0xA6 || cmd == 0xA7)
+		inverse = cmd == 0xA7;
+	else if(cmd == 0xAE || cmd == 0xAF)
+		displayOn = cmd == 0xAF;
+	else
+		arguments = Sim_OledArguments(cmd);
+}
+
+/*********************************************************************
+* Function:  void Sim_OledWrite(BOOL data, BYTE value)
+*
+* Input: data - D/C# level, value - D7:D0
+*
+* Overview: one write strobe on the bus
+*
+********************************************************************/
+void Sim_OledWrite(BOOL data, BYTE value)
+{
+	simCount.oledBytes++;
+	simCount.cycles += SIM_CYCLES_OLED_BYTE;
+
+	if(data)
+	{
+		if(column < OLED_COLUMNS)
+			ram[page][column] = value;
+		column++;
+		return;
+	}
+
+	if(arguments)
+	{
+		arguments--;							// arguments only tune the panel drive
+		return;
+	}
+	Sim_OledCommand(value);
+}
+
+/*********************************************************************
+* Function:  BOOL Sim_OledPixel(BYTE x, BYTE y)
+*
+* Input: x - 0..127, y - 0..63 from the top left of the panel
+*
+* Output: TRUE if the pixel is lit
+*
+********************************************************************/
+BOOL Sim_OledPixel(BYTE x, BYTE y)
+{
+	BYTE line;
+	BOOL lit;
+
+	if(!displayOn)
+		return FALSE;
+
+	line = (y + startLine) & (OLED_LINES - 1);
+	lit = (ram[line >> 3][x + OFFSET] >> (line & 7)) & 1;
+	return inverse ? !lit : lit;
+}
+
+/*********************************************************************
+* Function:  void Sim_OledAscii(FILE *out)
+*
+* Overview: prints the panel, two pixel rows per text line
+*
+********************************************************************/
+void Sim_OledAscii(FILE *out)
+{
+	static const char cell[4] = { ' ', '\'', '.', ':' };
+	BYTE x, y;
+
+	fputc('+', out);
+	for(x = 0; x < SCREEN_HOR_SIZE; x++)
+		fputc('-', out);
+	fputs("+\n", out);
+
+	for(y = 0; y < SCREEN_VER_SIZE; y += 2)
+	{
+		fputc('|', out);
+		for(x = 0; x < SCREEN_HOR_SIZE; x++)
+			fputc(cell[Sim_OledPixel(x, y) | (Sim_OledPixel(x, y + 1) << 1)], out);
+		fputs("|\n", out);
+	}
+
+	fputc('+', out);
+	for(x = 0; x < SCREEN_HOR_SIZE; x++)
+		fputc('-', out);
+	fputs("+\n", out);
+}
+
+/*********************************************************************
+* Function:  BOOL Sim_OledPbm(const char *path)
+*
+* Output: FALSE if the file could not be written
+*
+* Overview: saves the panel as a binary PBM, lit pixels white
+*
+********************************************************************/
+BOOL Sim_OledPbm(const char *path)
+{
+	FILE *f;
+	BYTE x, y, bits;
+
+	f = fopen(path, "wb");
+	if(f == NULL)
+		return FALSE;
+
+	fprintf(f, "P4\n%d %d\n", SCREEN_HOR_SIZE, SCREEN_VER_SIZE);
+	for(y = 0; y < SCREEN_VER_SIZE; y++)
+	{
+		bits = 0;
+		for(x = 0; x < SCREEN_HOR_SIZE; x++)
+		{
+			bits = (bits << 1) | !Sim_OledPixel(x, y);
+			if((x & 7) == 7)
+				fputc(bits, f);
+		}
+	}
+
+	return fclose(f) == 0;
+}